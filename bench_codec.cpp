@@ -0,0 +1,176 @@
+// Hex / base64 codec benchmarks: the vectorized Codec against the scalar fallback and the
+// BIO / ostringstream code it replaced. Cross-checks every implementation on random inputs
+// first and exits non-zero on a mismatch, then prints one JSON object per line.
+//
+//   make bench_codec && ./bench_codec [--seconds S] [--quick]
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include "codec/Codec.h"
+#include "include/json.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static void emit(const nlohmann::json &j)
+{
+    std::cout << j.dump() << std::endl;
+}
+
+// ---- the implementations Codec replaced (copied from Crypto.cpp / Transaction.cpp) ----
+
+static std::string legacyHexEncode(const unsigned char *data, size_t len)
+{
+    std::ostringstream ss;
+    ss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < len; i++)
+        ss << std::setw(2) << (int)data[i];
+    return ss.str();
+}
+
+static std::vector<unsigned char> legacyBase64Decode(const std::string &in)
+{
+    BIO *b64 = BIO_new(BIO_f_base64());
+    BIO *bio = BIO_new_mem_buf(in.data(), (int)in.size());
+    bio = BIO_push(b64, bio);
+    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
+    std::vector<unsigned char> out(in.size());
+    int n = BIO_read(bio, out.data(), (int)out.size());
+    BIO_free_all(bio);
+    out.resize(n > 0 ? n : 0);
+    return out;
+}
+
+static std::string legacyBase64Encode(const unsigned char *data, size_t len)
+{
+    std::string out(4 * ((len + 2) / 3) + 1, '\0');
+    int n = EVP_EncodeBlock((unsigned char *)&out[0], data, (int)len);
+    out.resize(n);
+    return out;
+}
+
+// ---- harness ----
+
+static std::vector<unsigned char> randomBytes(std::mt19937 &rng, size_t n)
+{
+    std::vector<unsigned char> v(n);
+    for (auto &b : v)
+        b = (unsigned char)rng();
+    return v;
+}
+
+// run fn repeatedly for `seconds`, return bytes of input processed per second
+static double throughput(double seconds, size_t bytesPerCall, const std::function<size_t()> &fn)
+{
+    size_t sink = 0;
+    unsigned long long calls = 0;
+    auto start = Clock::now();
+    double elapsed = 0;
+    do
+    {
+        for (int i = 0; i < 64; i++)
+            sink += fn();
+        calls += 64;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < seconds);
+    if (sink == 42)
+        std::cerr << "";
+    return calls * (double)bytesPerCall / elapsed;
+}
+
+static bool crossCheck()
+{
+    std::mt19937 rng(1234);
+    for (size_t n = 0; n < 600; n++)
+    {
+        std::vector<unsigned char> bytes = randomBytes(rng, n);
+        std::string hexRef = legacyHexEncode(bytes.data(), n);
+        std::string b64Ref = legacyBase64Encode(bytes.data(), n);
+
+        for (Codec::Impl impl : {Codec::SCALAR, Codec::SSSE3, Codec::AVX2})
+        {
+            Codec::setImplementation(impl);
+            std::vector<unsigned char> back;
+            if (Codec::hexEncode(bytes.data(), n) != hexRef ||
+                !Codec::hexDecode(hexRef, back) || back != bytes ||
+                Codec::base64Encode(bytes.data(), n) != b64Ref ||
+                !Codec::base64Decode(b64Ref, back) || back != bytes)
+            {
+                emit({{"bench", "cross_check"}, {"ok", false}, {"impl", Codec::implementationName()}, {"len", n}});
+                return false;
+            }
+
+            // corrupt one character anywhere (including inside a vector block) -> must be rejected
+            if (n > 0)
+            {
+                std::string badHex = hexRef;
+                badHex[rng() % badHex.size()] = 'g';
+                std::string badB64 = b64Ref;
+                badB64[rng() % (b64Ref.size() - 2)] = '*';
+                if (Codec::hexDecode(badHex, back) || Codec::base64Decode(badB64, back))
+                {
+                    emit({{"bench", "cross_check"}, {"ok", false}, {"impl", Codec::implementationName()}, {"len", n}, {"case", "invalid"}});
+                    return false;
+                }
+            }
+        }
+    }
+    Codec::setImplementation(Codec::AVX2); // clamps back to the best supported kernel
+    emit({{"bench", "cross_check"}, {"ok", true}, {"best_impl", Codec::implementationName()}});
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--quick"))
+            seconds = 0.05;
+    }
+
+    if (!crossCheck())
+        return 1;
+
+    std::mt19937 rng(42);
+    // 32 = a SHA-256 digest (tx ids), 72 = a DER ECDSA signature, 4096 = bulk
+    for (size_t size : {32, 72, 4096})
+    {
+        std::vector<unsigned char> bytes = randomBytes(rng, size);
+        std::string hex = legacyHexEncode(bytes.data(), size);
+        std::string b64 = legacyBase64Encode(bytes.data(), size);
+
+        auto report = [&](const char *op, const char *impl, double bps)
+        {
+            emit({{"bench", "codec"}, {"op", op}, {"impl", impl}, {"bytes", size}, {"mb_per_sec", bps / 1e6}});
+        };
+
+        report("hex_encode", "ostringstream", throughput(seconds, size, [&] { return legacyHexEncode(bytes.data(), size).size(); }));
+        report("base64_decode", "openssl_bio", throughput(seconds, b64.size(), [&] { return legacyBase64Decode(b64).size(); }));
+        report("base64_encode", "openssl_evp", throughput(seconds, size, [&] { return legacyBase64Encode(bytes.data(), size).size(); }));
+
+        for (Codec::Impl impl : {Codec::SCALAR, Codec::SSSE3, Codec::AVX2})
+        {
+            Codec::setImplementation(impl);
+            if (Codec::implementation() != impl)
+                continue; // not supported on this CPU
+            const char *name = Codec::implementationName();
+            std::vector<unsigned char> out;
+            report("hex_encode", name, throughput(seconds, size, [&] { return Codec::hexEncode(bytes.data(), size).size(); }));
+            report("hex_decode", name, throughput(seconds, hex.size(), [&] { Codec::hexDecode(hex, out); return out.size(); }));
+            report("base64_decode", name, throughput(seconds, b64.size(), [&] { Codec::base64Decode(b64, out); return out.size(); }));
+            report("base64_encode", name, throughput(seconds, size, [&] { return Codec::base64Encode(bytes.data(), size).size(); }));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+// Crypto benchmarks and correctness checks. Keys are generated locally (P-256, like WebCrypto),
+// so nothing outside the repo is needed. Checks run first and the exit code is non-zero if any
+// fails; then one JSON object per line so runs of different builds can be diffed.
+//
+//   make bench_crypto && ./bench_crypto [--threads N] [--seconds S] [--quick]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include <openssl/sha.h>
+#include "crypto/Crypto.h"
+#include "crypto/Sha256.h"
+#include "codec/Codec.h"
+#include "include/json.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double seconds = 1.0;
+    bool quick = false;
+};
+
+static void emit(const nlohmann::json &j)
+{
+    std::cout << j.dump() << std::endl;
+}
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// a signing key plus everything the verify paths take as input
+struct Fixture
+{
+    std::shared_ptr<EVP_PKEY> priv;
+    std::shared_ptr<EVP_PKEY> pub; // public half only, as the server holds it
+    std::string pubPem;
+    std::string message = "WALLET_100001|WALLET_900001|12.5|0.01";
+    std::string derSigB64;
+    std::string rawSigB64; // r||s, what WebCrypto produces
+};
+
+static Fixture makeFixture()
+{
+    Fixture f;
+    f.priv.reset(EVP_EC_gen("P-256"), EVP_PKEY_free);
+
+    BIO *bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_PUBKEY(bio, f.priv.get());
+    char *data = nullptr;
+    long len = BIO_get_mem_data(bio, &data);
+    f.pubPem.assign(data, len);
+    BIO_free(bio);
+    f.pub = Crypto::parsePublicKeyPEM(f.pubPem);
+
+    unsigned char der[80];
+    size_t derLen = sizeof(der);
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, f.priv.get());
+    EVP_DigestSign(ctx, der, &derLen, (const unsigned char *)f.message.data(), f.message.size());
+    EVP_MD_CTX_free(ctx);
+    f.derSigB64 = Codec::base64Encode(der, derLen);
+
+    const unsigned char *p = der;
+    ECDSA_SIG *sig = d2i_ECDSA_SIG(nullptr, &p, (long)derLen);
+    unsigned char raw[64];
+    BN_bn2binpad(ECDSA_SIG_get0_r(sig), raw, 32);
+    BN_bn2binpad(ECDSA_SIG_get0_s(sig), raw + 32, 32);
+    ECDSA_SIG_free(sig);
+    f.rawSigB64 = Codec::base64Encode(raw, 64);
+    return f;
+}
+
+// ---------------------------------------------------
+//  0. correctness
+// ---------------------------------------------------
+static bool runChecks(const Fixture &f)
+{
+    bool all = true;
+    auto check = [&](const char *name, bool ok)
+    {
+        emit({{"bench", "check"}, {"name", name}, {"ok", ok}});
+        all = all && ok;
+    };
+
+    std::string tamperedSig = f.rawSigB64;
+    tamperedSig[10] = tamperedSig[10] == 'A' ? 'B' : 'A';
+
+    check("verify_der", Crypto::verifySignature(f.pub.get(), f.message, f.derSigB64));
+    check("verify_raw", Crypto::verifySignature(f.pub.get(), f.message, f.rawSigB64));
+    check("verify_pem", Crypto::verifySignaturePEM(f.pubPem, f.message, f.rawSigB64));
+    check("reject_tampered_message", !Crypto::verifySignature(f.pub.get(), f.message + "0", f.rawSigB64));
+    check("reject_tampered_signature", !Crypto::verifySignature(f.pub.get(), f.message, tamperedSig));
+    check("reject_bad_base64", !Crypto::verifySignature(f.pub.get(), f.message, "not base64!"));
+    check("reject_null_key", !Crypto::verifySignature(nullptr, f.message, f.rawSigB64));
+
+    CompactPublicKey compact;
+    bool compacted = Crypto::compactPublicKey(f.pub.get(), compact);
+    std::shared_ptr<EVP_PKEY> rebuilt = compacted ? Crypto::publicKeyFromCompact(compact) : nullptr;
+    check("compact_key_roundtrip", rebuilt && Crypto::publicKeyToPEM(rebuilt.get()) == f.pubPem &&
+                                       Crypto::verifySignature(rebuilt.get(), f.message, f.rawSigB64));
+
+    // FIPS 180-2 test vector
+    check("sha256_abc", Crypto::sha256_hex("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    std::string text(1000, 'x');
+    unsigned char whole[32], pieces[32];
+    Sha256::digest(text.data(), text.size(), whole);
+    Sha256().update(text.data(), 1).update(text.data() + 1, 499).update(text.data() + 500, 500).final(pieces);
+    check("sha256_incremental", !memcmp(whole, pieces, 32));
+
+    return all;
+}
+
+// ---------------------------------------------------
+//  1. single-thread verify cost per path
+// ---------------------------------------------------
+template <typename Fn>
+static void benchVerify(const Options &opt, const char *path, Fn verify)
+{
+    unsigned long long n = 0, ok = 0;
+    auto start = Clock::now();
+    while (secondsSince(start) < opt.seconds)
+    {
+        for (int i = 0; i < 16; i++, n++)
+            ok += verify();
+    }
+    double elapsed = secondsSince(start);
+
+    emit({{"bench", "verify"},
+          {"path", path},
+          {"verifies", n},
+          {"all_ok", ok == n},
+          {"seconds", elapsed},
+          {"verifies_per_sec", n / elapsed},
+          {"us_per_verify", elapsed * 1e6 / n}});
+}
+
+static void benchVerifyPaths(const Options &opt, const Fixture &f)
+{
+    // cached: key parsed once (KeyCache / compact wallet keys), the server's path
+    benchVerify(opt, "cached_key_der", [&]
+                { return Crypto::verifySignature(f.pub.get(), f.message, f.derSigB64); });
+    benchVerify(opt, "cached_key_raw", [&]
+                { return Crypto::verifySignature(f.pub.get(), f.message, f.rawSigB64); });
+
+    // cold: PEM parsed for every signature, as before keys were cached
+    benchVerify(opt, "cold_pem_raw", [&]
+                { return Crypto::verifySignaturePEM(f.pubPem, f.message, f.rawSigB64); });
+
+    // cold from the compact form: key rebuilt from the 33-byte point each time
+    CompactPublicKey compact;
+    Crypto::compactPublicKey(f.pub.get(), compact);
+    benchVerify(opt, "cold_compact_raw", [&]
+                {
+        std::shared_ptr<EVP_PKEY> key = Crypto::publicKeyFromCompact(compact);
+        return Crypto::verifySignature(key.get(), f.message, f.rawSigB64); });
+}
+
+// ---------------------------------------------------
+//  2. verify scaling across 1..N threads sharing one key
+// ---------------------------------------------------
+static void benchVerifyScaling(const Options &opt, const Fixture &f)
+{
+    double baseline = 0;
+    for (unsigned n = 1; n <= opt.threads; n++)
+    {
+        std::atomic<bool> stop{false};
+        std::vector<unsigned long long> counts(n, 0);
+        std::vector<std::thread> workers;
+
+        auto start = Clock::now();
+        for (unsigned t = 0; t < n; t++)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    for (int i = 0; i < 16; i++)
+                        Crypto::verifySignature(f.pub.get(), f.message, f.rawSigB64);
+                    counts[t] += 16;
+                } });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(opt.seconds));
+        stop = true;
+        for (auto &w : workers)
+            w.join();
+        double elapsed = secondsSince(start);
+
+        unsigned long long total = 0;
+        for (auto c : counts)
+            total += c;
+        double rate = total / elapsed;
+        if (n == 1)
+            baseline = rate;
+
+        emit({{"bench", "verify_scaling"},
+              {"threads", n},
+              {"verifies", total},
+              {"seconds", elapsed},
+              {"verifies_per_sec", rate},
+              {"speedup", baseline > 0 ? rate / baseline : 0.0}});
+    }
+}
+
+// ---------------------------------------------------
+//  3. SHA-256 throughput by input size
+// ---------------------------------------------------
+static void benchSha256(const Options &opt)
+{
+    std::vector<size_t> sizes = opt.quick ? std::vector<size_t>{32, 1024, 65536}
+                                          : std::vector<size_t>{32, 64, 256, 1024, 16384, 1 << 20};
+    for (size_t size : sizes)
+    {
+        std::string input(size, 'u');
+        unsigned char out[32];
+
+        auto run = [&](const char *impl, auto hash)
+        {
+            unsigned long long n = 0;
+            auto start = Clock::now();
+            while (secondsSince(start) < opt.seconds)
+            {
+                for (int i = 0; i < 8; i++, n++)
+                    hash();
+                input[0] = (char)out[0]; // depend on the previous result
+            }
+            double elapsed = secondsSince(start);
+            emit({{"bench", "sha256"},
+                  {"impl", impl},
+                  {"bytes", size},
+                  {"hashes_per_sec", n / elapsed},
+                  {"mb_per_sec", n * (double)size / elapsed / 1e6}});
+        };
+
+        run("thread_ctx", [&]
+            { Sha256::digest(input.data(), input.size(), out); });
+        run("oneshot", [&]
+            { SHA256((const unsigned char *)input.data(), input.size(), out); });
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+            opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc)
+            opt.seconds = std::max(0.05, std::atof(argv[++i]));
+        else if (!std::strcmp(argv[i], "--quick"))
+        {
+            opt.quick = true;
+            opt.seconds = 0.2;
+        }
+    }
+
+    emit({{"bench", "meta"},
+          {"compiler", __VERSION__},
+          {"openssl", OpenSSL_version(OPENSSL_VERSION)},
+          {"codec", Codec::implementationName()},
+          {"threads", opt.threads},
+          {"seconds", opt.seconds}});
+
+    Fixture f = makeFixture();
+    if (!f.pub || !runChecks(f))
+        return 1;
+
+    benchVerifyPaths(opt, f);
+    benchVerifyScaling(opt, f);
+    benchSha256(opt);
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+// Mining / block hashing benchmarks.
+// Prints one JSON object per line so runs of different miner builds can be diffed or loaded into a script.
+//
+//   make bench_mining && ./bench_mining [--threads N] [--trials N] [--seconds S] [--quick]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include "block/Block.h"
+#include "mining/Difficulty.h"
+#include "include/json.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int trials = 50;
+    double seconds = 1.0;
+    bool quick = false;
+};
+
+static void emit(const nlohmann::json &j)
+{
+    std::cout << j.dump() << std::endl;
+}
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static std::vector<Transaction> makeTransactions(size_t n)
+{
+    std::vector<Transaction> txs;
+    txs.reserve(n);
+    for (size_t i = 0; i < n; i++)
+        txs.emplace_back("WALLET_" + std::to_string(100000 + i), "WALLET_" + std::to_string(900000 - i), 1.0 + i);
+    return txs;
+}
+
+// hash the same header with increasing nonces for a fixed time, return hashes done
+static unsigned long long hashFor(Block &block, double seconds, const std::atomic<bool> *stop = nullptr)
+{
+    unsigned long long hashes = 0;
+    size_t sink = 0;
+    auto start = Clock::now();
+    while (true)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            block.nonce++;
+            sink ^= block.calculateHashValue();
+        }
+        hashes += 256;
+        if (stop ? stop->load(std::memory_order_relaxed) : secondsSince(start) >= seconds)
+            break;
+    }
+    block.hash = std::to_string(sink); // keep the loop from being optimized away
+    return hashes;
+}
+
+// ---------------------------------------------------
+//  1. raw header hashing rate (empty block)
+// ---------------------------------------------------
+static void benchHeaderHash(const Options &opt)
+{
+    Block block(1, "bench", {}, "0");
+    auto start = Clock::now();
+    unsigned long long hashes = hashFor(block, opt.seconds);
+    double elapsed = secondsSince(start);
+
+    emit({{"bench", "header_hash"},
+          {"hashes", hashes},
+          {"seconds", elapsed},
+          {"hashes_per_sec", hashes / elapsed},
+          {"ns_per_hash", elapsed * 1e9 / hashes}});
+}
+
+// ---------------------------------------------------
+//  2. scaling across 1..N threads, each on its own nonce range
+// ---------------------------------------------------
+static void benchThreadScaling(const Options &opt)
+{
+    double baseline = 0;
+    for (unsigned n = 1; n <= opt.threads; n++)
+    {
+        std::atomic<bool> stop{false};
+        std::vector<unsigned long long> counts(n, 0);
+        std::vector<std::thread> workers;
+
+        auto start = Clock::now();
+        for (unsigned t = 0; t < n; t++)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                Block block(1, "bench", {}, "0");
+                block.nonce = (long long)t << 40;
+                counts[t] = hashFor(block, 0, &stop); });
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(opt.seconds));
+        stop = true;
+        for (auto &w : workers)
+            w.join();
+        double elapsed = secondsSince(start);
+
+        unsigned long long total = 0;
+        for (auto c : counts)
+            total += c;
+        double rate = total / elapsed;
+        if (n == 1)
+            baseline = rate;
+
+        emit({{"bench", "thread_scaling"},
+              {"threads", n},
+              {"hashes", total},
+              {"seconds", elapsed},
+              {"hashes_per_sec", rate},
+              {"speedup", baseline > 0 ? rate / baseline : 0.0}});
+    }
+}
+
+// ---------------------------------------------------
+//  3. time-to-solution distribution per difficulty
+// ---------------------------------------------------
+static double percentile(std::vector<double> sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+static void benchTimeToSolution(const Options &opt)
+{
+    std::vector<int> bits = opt.quick ? std::vector<int>{8, 10, 12} : std::vector<int>{8, 10, 12, 14, 16};
+
+    for (int b : bits)
+    {
+        uint64_t target = Difficulty::MAX_TARGET >> b;
+        std::vector<double> ms;
+        unsigned long long totalNonces = 0;
+
+        for (int trial = 0; trial < opt.trials; trial++)
+        {
+            Block block(trial, "bench-" + std::to_string(b) + "-" + std::to_string(trial), {}, "0");
+            auto start = Clock::now();
+            block.mineBlock(target);
+            ms.push_back(secondsSince(start) * 1000.0);
+            totalNonces += block.nonce + 1;
+        }
+
+        std::sort(ms.begin(), ms.end());
+        double sum = 0;
+        for (double v : ms)
+            sum += v;
+
+        emit({{"bench", "time_to_solution"},
+              {"target", target},
+              {"difficulty", Difficulty::workFor(target)},
+              {"trials", opt.trials},
+              {"mean_nonces", (double)totalNonces / opt.trials},
+              {"mean_ms", sum / ms.size()},
+              {"min_ms", ms.front()},
+              {"p50_ms", percentile(ms, 0.50)},
+              {"p90_ms", percentile(ms, 0.90)},
+              {"p99_ms", percentile(ms, 0.99)},
+              {"max_ms", ms.back()}});
+    }
+}
+
+// ---------------------------------------------------
+//  4. hashing cost as the block grows
+// ---------------------------------------------------
+static void benchBlockSize(const Options &opt)
+{
+    std::vector<size_t> sizes = opt.quick ? std::vector<size_t>{0, 10, 100} : std::vector<size_t>{0, 1, 10, 100, 1000};
+    double emptyNs = 0;
+
+    for (size_t n : sizes)
+    {
+        Block block(1, "bench", makeTransactions(n), "0");
+        auto start = Clock::now();
+        unsigned long long hashes = hashFor(block, opt.seconds / 2);
+        double elapsed = secondsSince(start);
+        double nsPerHash = elapsed * 1e9 / hashes;
+        if (n == 0)
+            emptyNs = nsPerHash;
+
+        emit({{"bench", "block_size"},
+              {"transactions", n},
+              {"hashes", hashes},
+              {"hashes_per_sec", hashes / elapsed},
+              {"ns_per_hash", nsPerHash},
+              {"ns_per_tx", n > 0 ? (nsPerHash - emptyNs) / n : 0.0}});
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+            opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--trials") && i + 1 < argc)
+            opt.trials = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc)
+            opt.seconds = std::max(0.05, std::atof(argv[++i]));
+        else if (!std::strcmp(argv[i], "--quick"))
+        {
+            opt.quick = true;
+            opt.trials = 10;
+            opt.seconds = 0.2;
+        }
+    }
+
+    emit({{"bench", "meta"},
+          {"compiler", __VERSION__},
+          {"threads", opt.threads},
+          {"trials", opt.trials},
+          {"seconds", opt.seconds}});
+
+    benchHeaderHash(opt);
+    benchThreadScaling(opt);
+    benchTimeToSolution(opt);
+    benchBlockSize(opt);
+
+    return 0;
+}
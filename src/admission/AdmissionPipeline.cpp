@@ -0,0 +1,351 @@
+#include "AdmissionPipeline.h"
+#include <cmath>
+#include <sstream>
+#include "../config/Config.h"
+#include "../crypto/Crypto.h"
+#include "../crypto/VerifyService.h"
+#include "../log/Logger.h"
+
+// -----------------------------
+//  Stage queue with parking
+// -----------------------------
+
+void AdmissionPipeline::Stage::push(Job *job, const std::atomic<bool> &stopping)
+{
+    bool pushed = queue.tryPush(job);
+    if (!pushed)
+    {
+        // downstream is full: wait for it rather than drop work that was already accepted
+        std::unique_lock<std::mutex> lock(mtx);
+        blocked.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in pop()
+        notFull.wait(lock, [&]()
+                     { return stopping.load() || (pushed = queue.tryPush(job)); });
+        blocked.fetch_sub(1);
+    }
+
+    if (!pushed)
+    {
+        // never enqueued, so the destructor's drain won't see it: answer it here
+        finish(job, false, "Server shutting down");
+        return;
+    }
+    wake();
+}
+
+AdmissionPipeline::Job *AdmissionPipeline::Stage::pop(const std::atomic<bool> &stopping)
+{
+    Job *job = nullptr;
+    bool popped = queue.tryPop(job);
+    if (!popped)
+    {
+        // register first, then re-check: a push that lands before the wait sees the registration
+        std::unique_lock<std::mutex> lock(mtx);
+        sleepers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in wake()
+        notEmpty.wait(lock, [&]()
+                      { return stopping.load() || (popped = queue.tryPop(job)); });
+        sleepers.fetch_sub(1);
+    }
+
+    if (!popped)
+        return nullptr;
+
+    // a slot just freed up for a producer parked in push()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (blocked.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        notFull.notify_one();
+    }
+    return job;
+}
+
+void AdmissionPipeline::Stage::wake()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst); // the push is visible before sleepers is read
+    if (sleepers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        notEmpty.notify_one();
+    }
+}
+
+void AdmissionPipeline::Stage::stop()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    notEmpty.notify_all();
+    notFull.notify_all();
+}
+
+// -----------------------------
+//  Pipeline
+// -----------------------------
+
+AdmissionPipeline::AdmissionPipeline(Blockchain &blockchain, WalletManager &walletManager,
+                                     size_t queueCapacity, size_t verifyThreads)
+    : blockchain(blockchain),
+      walletManager(walletManager),
+      checkStage(queueCapacity ? queueCapacity : (size_t)Config::getInt("UMA_ADMISSION_QUEUE", 1024)),
+      verifyStage(queueCapacity ? queueCapacity : (size_t)Config::getInt("UMA_ADMISSION_QUEUE", 1024)),
+      commitStage(queueCapacity ? queueCapacity : (size_t)Config::getInt("UMA_ADMISSION_QUEUE", 1024))
+{
+    if (verifyThreads == 0)
+        verifyThreads = (size_t)Config::getInt("UMA_ADMISSION_VERIFY_THREADS", std::thread::hardware_concurrency());
+    if (verifyThreads == 0)
+        verifyThreads = 1;
+
+    threads.emplace_back(&AdmissionPipeline::checkLoop, this);
+    for (size_t i = 0; i < verifyThreads; i++)
+        threads.emplace_back(&AdmissionPipeline::verifyLoop, this);
+    threads.emplace_back(&AdmissionPipeline::commitLoop, this);
+}
+
+AdmissionPipeline::~AdmissionPipeline()
+{
+    stopping = true;
+    for (Stage *stage : {&checkStage, &verifyStage, &commitStage})
+        stage->stop();
+    for (auto &t : threads)
+        t.join();
+
+    // nothing may be left with an unfulfilled promise
+    for (Stage *stage : {&checkStage, &verifyStage, &commitStage})
+    {
+        Job *job;
+        while (stage->queue.tryPop(job))
+            finish(job, false, "Server shutting down");
+    }
+}
+
+bool AdmissionPipeline::submit(AdmissionRequest request, std::future<AdmissionResult> &result)
+{
+    submitted++;
+
+    Job *job = new Job();
+    job->request = std::move(request);
+    result = job->promise.get_future();
+
+    if (stopping.load() || !checkStage.queue.tryPush(job))
+    {
+        rejectedBusy++;
+        delete job;
+        return false;
+    }
+    checkStage.wake();
+    return true;
+}
+
+void AdmissionPipeline::finish(Job *job, bool success, const std::string &message, double newBalance)
+{
+    AdmissionResult result;
+    result.success = success;
+    result.message = message;
+    result.newBalance = newBalance;
+    job->promise.set_value(result);
+    delete job;
+}
+
+// everything that doesn't need the signature verified yet
+std::string AdmissionPipeline::check(const AdmissionRequest &req, Checked &out)
+{
+    try
+    {
+        out.amount = std::stod(req.amount);
+        out.fee = req.fee.empty() ? 0.0 : std::stod(req.fee);
+    }
+    catch (const std::exception &)
+    {
+        return "Invalid amount";
+    }
+
+    // nan/inf parse fine but would poison balances and the mempool's priority ordering
+    if (!std::isfinite(out.amount) || out.amount <= 0)
+        return "Invalid amount";
+    if (!std::isfinite(out.fee) || out.fee < 0)
+        return "Invalid fee";
+
+    // validate if sender and reciever wallet exists
+    if (!walletManager.walletExists(req.sender) || !walletManager.walletExists(req.receiver))
+        return "Invalid Wallet Id";
+
+    // If pubKeyPem provided and the sender has no key yet, bind it
+    bool hasPub = walletManager.hasPublicKey(req.sender);
+    if (!hasPub && !req.pubKeyPem.empty())
+        hasPub = !walletManager.bindPublicKeyToWallet(req.sender, req.pubKeyPem).empty();
+
+    // parsed key comes from the wallet's cache (filled at bind time), no PEM parsing here
+    if (hasPub)
+        out.key = walletManager.getVerifyKey(req.sender, &out.keyId);
+
+    if (!out.key)
+        return "Public key not found for sender";
+
+    // the wallet's key can be rebound later; the tx keeps the one it is verified against
+    CompactPublicKey compact;
+    if (!Crypto::compactPublicKey(out.key.get(), compact))
+        return "Public key not found for sender";
+    out.signerKey = Crypto::compactKeyToString(compact);
+
+    std::ostringstream oss;
+    oss << req.sender << "|" << req.receiver << "|" << req.amount;
+    // the fee is signed too when the client sets one, so it can't be changed in flight
+    if (!req.fee.empty())
+        oss << "|" << req.fee;
+    out.message = oss.str();
+
+    LOG_DEBUG("add-transaction", {"sender", req.sender}, {"message", out.message}, {"signature", req.signature});
+    return "";
+}
+
+Transaction AdmissionPipeline::makeTransaction(const AdmissionRequest &req, const Checked &checked)
+{
+    Transaction tx(req.sender, req.receiver, checked.amount);
+    tx.fee = checked.fee;
+    tx.signatureBase64 = req.signature; // kept with the tx so blocks can be re-verified later
+    tx.signedMessage = checked.message;
+    tx.signerKey = checked.signerKey;
+    return tx;
+}
+
+const char *AdmissionPipeline::addResultMessage(Mempool::AddResult result)
+{
+    switch (result)
+    {
+    case Mempool::ADDED:
+        return "Transaction added successfully";
+    case Mempool::REFUSED:
+        return "Insufficient funds";
+    case Mempool::DUPLICATE:
+        return "Duplicate transaction";
+    default:
+        return "Mempool full, raise the fee or retry later";
+    }
+}
+
+void AdmissionPipeline::checkLoop()
+{
+    while (Job *job = checkStage.pop(stopping))
+    {
+        std::string error = check(job->request, *job);
+        if (!error.empty())
+        {
+            refused++;
+            finish(job, false, error);
+            continue;
+        }
+
+        verifyStage.push(job, stopping);
+    }
+}
+
+// verify: the expensive part, one job per thread at a time
+void AdmissionPipeline::verifyLoop()
+{
+    while (Job *job = verifyStage.pop(stopping))
+    {
+        if (!VerifyService::verifyNow({job->key, job->message, job->request.signature, job->keyId}))
+        {
+            refused++;
+            finish(job, false, "Invalid Signature");
+            continue;
+        }
+        commitStage.push(job, stopping);
+    }
+}
+
+// commit: balance check and insert on a single thread
+void AdmissionPipeline::commitLoop()
+{
+    while (Job *job = commitStage.pop(stopping))
+    {
+        const AdmissionRequest &req = job->request;
+        Transaction tx = makeTransaction(req, *job);
+
+        Mempool::AddResult added = blockchain.admitTransactions({tx})[0];
+        if (added != Mempool::ADDED)
+        {
+            refused++;
+            finish(job, false, addResultMessage(added));
+            continue;
+        }
+
+        accepted++;
+        job->promise.set_value({true, addResultMessage(added), blockchain.getEffectiveBalance(req.sender), tx.id});
+        delete job;
+    }
+}
+
+std::vector<AdmissionResult> AdmissionPipeline::submitBatch(std::vector<AdmissionRequest> requests)
+{
+    batches++;
+    submitted += requests.size();
+
+    std::vector<AdmissionResult> results(requests.size());
+    std::vector<Checked> checked(requests.size());
+
+    // 1. checks, in order (a key bound by an earlier item serves later ones)
+    std::vector<VerifyJob> verifyJobs;
+    std::vector<size_t> verifyIndex;
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        results[i].message = check(requests[i], checked[i]);
+        if (!results[i].message.empty())
+            continue;
+        verifyJobs.push_back({checked[i].key, checked[i].message, requests[i].signature, checked[i].keyId});
+        verifyIndex.push_back(i);
+    }
+
+    // 2. all signatures at once across the verify pool
+    std::vector<bool> verified = VerifyService::instance().verifyAll(std::move(verifyJobs));
+
+    std::vector<Transaction> txs;
+    std::vector<size_t> txIndex;
+    for (size_t k = 0; k < verified.size(); k++)
+    {
+        size_t i = verifyIndex[k];
+        if (!verified[k])
+        {
+            results[i].message = "Invalid Signature";
+            continue;
+        }
+        txs.push_back(makeTransaction(requests[i], checked[i]));
+        txIndex.push_back(i);
+    }
+
+    // 3. balance checks and inserts in batch order, one lock acquisition
+    std::vector<Mempool::AddResult> added;
+    if (!txs.empty())
+        added = blockchain.admitTransactions(txs);
+
+    for (size_t k = 0; k < added.size(); k++)
+    {
+        AdmissionResult &r = results[txIndex[k]];
+        r.success = added[k] == Mempool::ADDED;
+        r.message = addResultMessage(added[k]);
+        if (r.success)
+            r.txId = txs[k].id;
+    }
+
+    for (const auto &r : results)
+        (r.success ? accepted : refused)++;
+
+    return results;
+}
+
+nlohmann::json AdmissionPipeline::stats() const
+{
+    return {
+        {"submitted", submitted.load()},
+        {"accepted", accepted.load()},
+        {"refused", refused.load()},
+        {"rejectedBusy", rejectedBusy.load()},
+        {"batches", batches.load()},
+        {"queues", {
+            {"check", checkStage.queue.sizeApprox()},
+            {"verify", verifyStage.queue.sizeApprox()},
+            {"commit", commitStage.queue.sizeApprox()},
+        }},
+        {"queueCapacity", checkStage.queue.capacity()},
+    };
+}
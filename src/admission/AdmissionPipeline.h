@@ -0,0 +1,135 @@
+#ifndef ADMISSION_PIPELINE_H
+#define ADMISSION_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/evp.h>
+#include "BoundedQueue.h"
+#include "../blockchain/Blockchain.h"
+#include "../wallet/WalletManager.h"
+#include "../../include/json.hpp"
+
+// Fields of a POST /add-transaction, as parsed from the form by the HTTP handler
+struct AdmissionRequest
+{
+    std::string sender;
+    std::string receiver;
+    std::string amount; // kept as typed: it is part of the signed message
+    std::string fee;    // optional
+    std::string signature;
+    std::string pubKeyPem; // optional, bound if the sender has no key yet
+};
+
+struct AdmissionResult
+{
+    bool success = false;
+    std::string message;
+    double newBalance = 0; // sender's effective balance after admission (single submissions)
+    std::string txId;      // set when admitted
+};
+
+// Signed transaction admission as a pipeline of stages joined by bounded lock-free queues:
+//
+//   HTTP thread (parse) -> check -> verify (N threads) -> commit (1 thread) -> future
+//
+//   check:  amount/fee parsing, wallet existence, key binding/lookup, signed message
+//   verify: ECDSA verification in parallel (SigCache aware)
+//   commit: balance validation and mempool insert as one step under the chain lock, so two
+//           txs from the same sender can't both pass the balance check
+//
+// submitBatch() runs the same checks on the caller's thread, verifies the whole batch in
+// parallel on VerifyService and admits it with a single Blockchain::admitTransactions call.
+//
+// submit() fails straight away when the entry queue is full; stages further down wait for
+// room, so a backlog anywhere fills the entry queue and turns into fast rejections.
+class AdmissionPipeline
+{
+public:
+    // queueCapacity per stage (UMA_ADMISSION_QUEUE), verifyThreads 0 = one per core (UMA_ADMISSION_VERIFY_THREADS)
+    AdmissionPipeline(Blockchain &blockchain, WalletManager &walletManager,
+                      size_t queueCapacity = 0, size_t verifyThreads = 0);
+    ~AdmissionPipeline();
+
+    AdmissionPipeline(const AdmissionPipeline &) = delete;
+    AdmissionPipeline &operator=(const AdmissionPipeline &) = delete;
+
+    // false = pipeline saturated (answer 503); otherwise result is always fulfilled
+    bool submit(AdmissionRequest request, std::future<AdmissionResult> &result);
+
+    // results[i] is for requests[i]; blocks until the whole batch is decided
+    std::vector<AdmissionResult> submitBatch(std::vector<AdmissionRequest> requests);
+
+    nlohmann::json stats() const;
+
+private:
+    // what the check stage works out for a request
+    struct Checked
+    {
+        double amount = 0;
+        double fee = 0;
+        std::string message; // exact signed text
+        std::shared_ptr<EVP_PKEY> key;
+        std::string keyId;
+        std::string signerKey; // key in compact form, recorded on the tx for later revalidation
+    };
+
+    struct Job : Checked
+    {
+        AdmissionRequest request;
+        std::promise<AdmissionResult> promise;
+    };
+
+    // a queue plus places for its consumers to sleep when it runs dry and its producers when
+    // it is full. Sleepers register under mtx and re-check the queue before waiting; the other
+    // side only takes mtx to notify when someone is registered, so the fast path stays lock-free
+    struct Stage
+    {
+        explicit Stage(size_t capacity) : queue(capacity) {}
+
+        BoundedQueue<Job *> queue;
+        std::mutex mtx;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::atomic<int> sleepers{0}; // consumers waiting on notEmpty
+        std::atomic<int> blocked{0};  // producers waiting on notFull
+
+        void push(Job *job, const std::atomic<bool> &stopping); // waits for room; fails the job on shutdown
+        Job *pop(const std::atomic<bool> &stopping);            // nullptr once stopping
+        void wake();                                            // after a push from outside push()
+        void stop();                                            // wake every waiter (stopping is set)
+    };
+
+    // "" if req passes, otherwise the reason it is refused
+    std::string check(const AdmissionRequest &req, Checked &out);
+    static Transaction makeTransaction(const AdmissionRequest &req, const Checked &checked);
+    static const char *addResultMessage(Mempool::AddResult result);
+
+    void checkLoop();
+    void verifyLoop();
+    void commitLoop();
+    static void finish(Job *job, bool success, const std::string &message, double newBalance = 0);
+
+    Blockchain &blockchain;
+    WalletManager &walletManager;
+
+    Stage checkStage;
+    Stage verifyStage;
+    Stage commitStage;
+
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> threads;
+
+    std::atomic<unsigned long long> submitted{0};
+    std::atomic<unsigned long long> rejectedBusy{0};
+    std::atomic<unsigned long long> accepted{0};
+    std::atomic<unsigned long long> refused{0}; // failed a check (bad signature, funds, ...)
+    std::atomic<unsigned long long> batches{0};
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include <string>
 #include <sstream>
 #include <functional> // for std::hash
+#include "../mining/Difficulty.h"
 
 
 Block::Block(int idx, const std::string &time, const std::vector<Transaction> &txs, const std::string &prevHashValue)
@@ -12,20 +13,31 @@ Block::Block(int idx, const std::string &time, const std::vector<Transaction> &t
     transactions = txs;
     previousHash = prevHashValue;
     nonce = 0;
+    target = Difficulty::MAX_TARGET;
+    solveTimeMs = 0;
     hash = calculateHash();
 }
 
+std::string Block::calculateHash() const
+{
+    return std::to_string(calculateHashValue());
+}
+
 // hash generator using std::hash
-std::string Block::calculateHash()
+size_t Block::calculateHashValue() const
 {
     std::stringstream ss;
 
     // creating the raw input string with the block's data
     ss << index << timestamp << previousHash << nonce;
+    if (target != Difficulty::MAX_TARGET)
+        ss << target; // commits to the target it claims to meet; pre-retarget blocks keep their hash input
 
     // add all transactions into the hash input
     for(auto &tx : transactions){
-        ss << tx.sender << tx.receiver << tx.amount; 
+        ss << tx.sender << tx.receiver << tx.amount;
+        if (tx.fee != 0)
+            ss << tx.fee; // fee-less (and pre-fee) transactions keep their original hash input
     }
 
     std::hash<std::string> hasher; // std::string means the input we will pass inside the hasher function, in our case we are passing our canonical string
@@ -33,22 +45,45 @@ std::string Block::calculateHash()
         size_t is an unsigned integer type.
         and unsigned, guaranteed to be large enough to hold the size of the largest possible object on the platform. Typical widths: 32-bit on 32-bit systems, 64-bit on 64-bit systems.
     */
-    size_t hashValue = hasher(ss.str());
-
-    return std::to_string(hashValue);
+    return hasher(ss.str());
 }
 
 // our custom proof of work algorithm
-// the hash must start with "diffiuclty" number of zeros, that's it
-void Block::mineBlock(int difficulty)
+// the numeric hash value must be <= target; the smaller the target the more nonces we have to try
+void Block::mineBlock(uint64_t powTarget)
 {
-    std::string target(difficulty, '1'); // e,g if difficulty = 3, then target = "111"
-    
-    while (hash.substr(0, difficulty) != target)
+    mineBlock(powTarget, nullptr);
+}
+
+// same loop, but polls shouldStop every STOP_CHECK_INTERVAL nonces so a miner can abandon stale work
+bool Block::mineBlock(uint64_t powTarget, const std::function<bool()> &shouldStop)
+{
+    static constexpr long long STOP_CHECK_INTERVAL = 1024;
+
+    target = powTarget;
+
+    size_t hashValue = calculateHashValue();
+    while ((uint64_t)hashValue > target)
     {
-        // std::cout << "new hash : " << hash << std::endl;
         nonce++;
-        hash = calculateHash();
+        if (shouldStop && nonce % STOP_CHECK_INTERVAL == 0 && shouldStop())
+            return false;
+        hashValue = calculateHashValue();
+    }
+
+    hash = std::to_string(hashValue);
+    return true;
+}
+
+bool Block::meetsTarget() const
+{
+    try
+    {
+        return std::stoull(hash) <= target;
+    }
+    catch (...)
+    {
+        return false;
     }
 }
 
@@ -59,6 +94,8 @@ nlohmann::json Block::toJSON() const {
     j["previousHash"] = previousHash;
     j["hash"] = hash;
     j["nonce"] = nonce;
+    j["target"] = target;
+    j["solveTimeMs"] = solveTimeMs;
     j["transactions"] = nlohmann::json::array();
 
     for (const auto &tx : transactions) j["transactions"].push_back(tx.toJSON());
@@ -74,6 +111,10 @@ Block Block::fromJSON(const nlohmann::json &j) {
     for (auto &t : j["transactions"]) txs.push_back(Transaction::fromJSON(t));
     Block b(idx, ts, txs, prev);
     b.hash = j.value("hash", std::string());
-    b.nonce = j.value("nonce", 0);
+    b.nonce = j.value("nonce", 0LL);
+    // blocks written before retargeting carry no target; "any hash" is only accepted on the
+    // pre-retarget prefix of a chain (see Difficulty::follow), and a real target is in the hash
+    b.target = j.value("target", Difficulty::MAX_TARGET);
+    b.solveTimeMs = j.value("solveTimeMs", 0LL);
     return b;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <functional>
 #include "../transaction/Transaction.h"
 #include "../../include/json.hpp"
 
@@ -14,12 +16,17 @@ class Block
         std::vector<Transaction> transactions;
         std::string previousHash;
         std::string hash;
-        int nonce;
+        long long nonce;
+        uint64_t target;       // PoW target this block was mined against (hash value must be <= target)
+        long long solveTimeMs; // wall-clock time spent mining, feeds difficulty retargeting
 
         Block(int idx, const std::string &time, const std::vector<Transaction> &txs, const std::string &prevHash);
 
-        std::string calculateHash();
-        void mineBlock(int difficulty);
+        std::string calculateHash() const;
+        size_t calculateHashValue() const;
+        void mineBlock(uint64_t powTarget);
+        bool mineBlock(uint64_t powTarget, const std::function<bool()> &shouldStop); // false if stopped before a solution
+        bool meetsTarget() const;
 
         nlohmann::json toJSON() const;
         static Block fromJSON(const nlohmann::json &j);
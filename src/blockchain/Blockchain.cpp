@@ -4,120 +4,407 @@
 #include <limits>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 #include "../../include/json.hpp"
+#include "../config/Config.h"
+#include "../events/EventHub.h"
+#include "../log/Logger.h"
+#include "../metrics/Metrics.h"
+#include "../storage/Persist.h"
 
 Blockchain::Blockchain()
+    : mempool((size_t)Config::getInt("UMA_MEMPOOL_MAX_BYTES", 64LL * 1024 * 1024),
+              Config::getInt("UMA_MEMPOOL_TTL_SEC", 3600) * 1000),
+      difficulty(Config::getInt("UMA_TARGET_BLOCK_MS", 1000),
+                 (size_t)Config::getInt("UMA_RETARGET_WINDOW", 20)),
+      templates((size_t)Config::getInt("UMA_TEMPLATE_RESTART_MIN_TX", 1),
+                Config::getInt("UMA_TEMPLATE_RESTART_MS", 250),
+                (size_t)Config::getInt("UMA_BLOCK_MAX_TX", 500),
+                (size_t)Config::getInt("UMA_BLOCK_MAX_BYTES", 256 * 1024)),
+      compressLevel((int)Config::getInt("UMA_COMPRESS_CACHED_LEVEL", 9))
 {
     loadFromFile();
-    difficulty = 5;
     miningReward = 2.0;
 
-    if (chain.empty())
+    if (!chain || chain->empty())
     {
-        chain.push_back(createGenesisBlock());
+        chain = std::make_shared<const ChainSnapshot>();
+        appendBlock(createGenesisBlock());
         saveToFile();
     }
+
+    restoreDifficulty();
+    refreshTemplate(true);
+    registerMetrics();
+}
+
+// gauges read at scrape time; the mempool ones take its lock once each, nothing else blocks
+void Blockchain::registerMetrics()
+{
+    Metrics::sampled("uma_chain_height", "Blocks in the chain", "gauge", [this]
+                     { return (double)snapshot()->size(); });
+    Metrics::sampled("uma_mining_difficulty", "Expected hashes per block at the current target", "gauge", [this]
+                     { return getDifficulty(); });
+
+    Metrics::sampled("uma_mempool_transactions", "Pending transactions", "gauge", [this]
+                     { return (double)mempool.stats().count; });
+    Metrics::sampled("uma_mempool_bytes", "Bytes held by pending transactions", "gauge", [this]
+                     { return (double)mempool.stats().bytes; });
+    Metrics::sampled("uma_mempool_max_bytes", "Mempool memory budget (0 = unbounded)", "gauge", [this]
+                     { return (double)mempool.stats().maxBytes; });
+    Metrics::sampled("uma_mempool_admitted_total", "Transactions admitted to the mempool", "counter", [this]
+                     { return (double)mempool.stats().admitted; });
+    Metrics::sampled("uma_mempool_evicted_total", "Transactions evicted to stay within budget", "counter", [this]
+                     { return (double)mempool.stats().evicted; });
+    Metrics::sampled("uma_mempool_expired_total", "Transactions dropped by TTL", "counter", [this]
+                     { return (double)mempool.stats().expired; });
+    Metrics::sampled("uma_mempool_rejected_full_total", "Transactions refused because the mempool was full", "counter", [this]
+                     { return (double)mempool.stats().rejectedFull; });
 }
 
 Block Blockchain::createGenesisBlock()
 {
     Block newBlock(0, "2025-25-11", {}, "0");
-    newBlock.mineBlock(difficulty);
+    sealBlock(newBlock);
 
     return newBlock;
 }
 
+// -----------------------------------------------------------
+//  Mine a block at the current target and time it; the retarget
+//  happens when the block is actually appended to the chain
+// -----------------------------------------------------------
+bool Blockchain::sealBlock(Block &block, const std::function<bool()> &shouldStop)
+{
+    static const Metrics::Id hashes = Metrics::counter("uma_mining_hashes_total", "PoW hashes computed");
+    static const Metrics::Id solved = Metrics::counter("uma_mining_attempts_total", "PoW attempts", "result=\"solved\"");
+    static const Metrics::Id abandoned = Metrics::counter("uma_mining_attempts_total", "PoW attempts", "result=\"abandoned\"");
+    static const Metrics::Id solveTime = Metrics::histogram("uma_mining_solve_duration_seconds", "Time to find a solution, solved attempts only");
+
+    auto started = std::chrono::steady_clock::now();
+    long long firstNonce = block.nonce;
+    bool ok = block.mineBlock(difficulty.currentTarget(), shouldStop);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    Metrics::add(hashes, (uint64_t)(block.nonce - firstNonce + 1));
+    if (!ok)
+    {
+        Metrics::add(abandoned);
+        return false;
+    }
+
+    Metrics::add(solved);
+    Metrics::record(solveTime, elapsed);
+    block.solveTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    return true;
+}
+
+void Blockchain::restoreDifficulty()
+{
+    // replay the whole chain through the retarget schedule, so the next target is the one
+    // revalidate() expects (blocks from before retargeting carry MAX_TARGET and are skipped)
+    difficulty.reset(Difficulty::INITIAL_TARGET);
+    for (const auto &block : chain->blocks)
+    {
+        if (difficulty.follow(block->target, block->solveTimeMs))
+            continue;
+
+        // keep serving from what's on disk; revalidate() reports the block
+        LOG_WARN("block off the retarget schedule", {"block", block->index});
+        difficulty.reset(block->target);
+        difficulty.recordBlock(block->target, block->solveTimeMs);
+    }
+}
+
 Block Blockchain::getLatestBlock()
 {
-    return chain.back();
+    return snapshot()->tip();
+}
+
+void Blockchain::appendBlock(const Block &block)
+{
+    auto next = std::make_shared<ChainSnapshot>();
+    next->version = chain->version + 1;
+    next->blocks.reserve(chain->size() + 1);
+    next->blockJSON.reserve(chain->size() + 1);
+    next->blocks = chain->blocks;
+    next->blockJSON = chain->blockJSON;
+    next->groupDeflate = chain->groupDeflate;
+    next->push(std::make_shared<const Block>(block), compressLevel); // serialized here, once
+    uint64_t version = next->version;
+
+    std::atomic_store(&chain, ChainView(std::move(next)));
+
+    std::lock_guard<std::mutex> lock(walletVersionMutex);
+    for (const auto &tx : block.transactions)
+    {
+        walletVersions[tx.sender] = version;
+        walletVersions[tx.receiver] = version;
+    }
 }
 
 // -----------------------------------
-//      Add transaction to mempool
+//      Chain events (SSE)
 // -----------------------------------
 
-void Blockchain::addTransaction(const Transaction &tx)
+// block-sealed + tx-confirmed for each of its txs
+static std::vector<EventHub::Prepared> blockEvents(const Block &block)
 {
+    std::vector<EventHub::Prepared> out;
+    out.reserve(block.transactions.size() + 1);
+
+    double fees = 0.0;
+    for (const auto &tx : block.transactions)
+        fees += tx.fee;
+
+    out.push_back(EventHub::prepare("block-sealed", {{"index", block.index},
+                                                     {"hash", block.hash},
+                                                     {"previousHash", block.previousHash},
+                                                     {"timestamp", block.timestamp},
+                                                     {"transactions", block.transactions.size()},
+                                                     {"fees", fees},
+                                                     {"difficulty", Difficulty::workFor(block.target)}}));
+
+    for (const auto &tx : block.transactions)
+    {
+        nlohmann::json data = tx.toJSON();
+        data["blockIndex"] = block.index;
+        data["blockHash"] = block.hash;
+        out.push_back(EventHub::prepare("tx-confirmed", data, {tx.sender, tx.receiver}));
+    }
+    return out;
+}
 
-    mempool.push_back(tx);
+static EventHub::Prepared admittedEvent(const Transaction &tx)
+{
+    return EventHub::prepare("tx-admitted", tx.toJSON(), {tx.sender, tx.receiver});
 }
 
-// -----------------------------------------------------
-//      Mine block containing all transaction in mempool
-// -----------------------------------------------------
+uint64_t Blockchain::walletVersion(const std::string &walletId) const
+{
+    std::lock_guard<std::mutex> lock(walletVersionMutex);
+    auto it = walletVersions.find(walletId);
+    return it == walletVersions.end() ? 0 : it->second;
+}
 
-bool Blockchain::minePendingTransactions(const std::string &minerAddress, WalletManager &walletManager)
+// -----------------------------------
+//      Add transaction to mempool
+// -----------------------------------
+
+Mempool::AddResult Blockchain::addTransaction(const Transaction &tx)
 {
-    if (mempool.empty())
+    std::vector<EventHub::Prepared> admitted;
+    if (events)
+        admitted.push_back(admittedEvent(tx));
+
+    Mempool::AddResult result;
     {
-        std::cout << "No pending transactions to mine!\n";
-        return false;
+        std::unique_lock<std::shared_mutex> lock(stateMutex);
+        expireMempool();
+
+        std::vector<Transaction> evicted;
+        result = mempool.add(tx, &evicted);
+        if (result != Mempool::ADDED)
+            return result;
+
+        if (!evicted.empty())
+        {
+            // evicted txs no longer count against their sender's balance, so they must not be mined
+            refreshTemplate(templates.containsAny(evicted));
+        }
+        else if (!templates.addTransaction(tx, Mempool::txBytes(tx)))
+        {
+            // keep the ready template current (may nudge an in-flight miner); a full template is
+            // rebuilt only when this tx pays enough to displace something in it
+            refreshTemplate(false);
+        }
+
+        if (events)
+            events->publish(std::move(admitted));
     }
 
-    // 1. Add block reward (free coins from system)
-    Transaction rewardTx("SYSTEM", minerAddress, miningReward);
-    rewardTx.status = TxStatus::CONFIRMED;
-    mempool.push_back(rewardTx);
+    return result;
+}
 
-    // 2. create block with all mempool transactions
-    int newIndex = chain.size();
+std::vector<Mempool::AddResult> Blockchain::admitTransactions(const std::vector<Transaction> &txs)
+{
+    std::vector<Mempool::AddResult> results;
+    std::vector<Transaction> evicted;
+    std::unordered_map<std::string, double> confirmed; // one chain scan per sender, not per tx
 
-    // get current time
-    time_t now = time(0);
+    std::vector<EventHub::Prepared> rendered; // rendered[i] is for txs[i]
+    if (events)
+        for (const auto &tx : txs)
+            rendered.push_back(admittedEvent(tx));
 
-    std::string timestr = ctime(&now);
+    {
+        std::unique_lock<std::shared_mutex> lock(stateMutex);
+        expireMempool();
+
+        mempool.addBatch(txs, [&](const Transaction &tx, double pendingOut)
+                         {
+            auto it = confirmed.find(tx.sender);
+            if (it == confirmed.end())
+                it = confirmed.emplace(tx.sender, confirmedBalance(*chain, tx.sender)).first;
+
+            double effective = it->second - pendingOut - reservedFor(tx.sender);
+            if (effective < tx.amount + tx.fee)
+            {
+                LOG_INFO("rejected: insufficient effective funds", {"sender", tx.sender}, {"amount", tx.amount}, {"available", effective});
+                return false;
+            }
+            return true; },
+                         results, &evicted);
+
+        // same template upkeep as addTransaction, once for the batch
+        if (!evicted.empty())
+        {
+            refreshTemplate(templates.containsAny(evicted));
+        }
+        else
+        {
+            bool overflow = false;
+            for (size_t i = 0; i < txs.size(); i++)
+                if (results[i] == Mempool::ADDED && !templates.addTransaction(txs[i], Mempool::txBytes(txs[i])))
+                    overflow = true;
+            if (overflow)
+                refreshTemplate(false);
+        }
+
+        if (events)
+        {
+            std::vector<EventHub::Prepared> admitted;
+            for (size_t i = 0; i < txs.size(); i++)
+                if (results[i] == Mempool::ADDED)
+                    admitted.push_back(std::move(rendered[i]));
+            events->publish(std::move(admitted));
+        }
+    }
+
+    return results;
+}
 
-    // ctime() returns a string that usually ends with '\n' (and on Windows may include '\r').
-    // Remove trailing CR/LF so timestamps don't introduce blank lines in saved files.
+void Blockchain::refreshTemplate(bool invalidate)
+{
+    templates.reset((int)chain->size(), chain->tip().hash,
+                    mempool.selectForBlock(templates.maxTransactions(), templates.maxBytes()),
+                    invalidate);
+}
+
+void Blockchain::expireMempool()
+{
+    if (mempool.expire() > 0)
+        refreshTemplate(true);
+}
+
+// ctime() returns a string that usually ends with '\n' (and on Windows may include '\r').
+// Remove trailing CR/LF so timestamps don't introduce blank lines in saved files.
+static std::string currentTimestamp()
+{
+    time_t now = time(0);
+    std::string timestr = ctime(&now);
     while (!timestr.empty() && (timestr.back() == '\n' || timestr.back() == '\r'))
-    {
         timestr.pop_back();
-    }
+    return timestr;
+}
 
-    /*
-        setting the pending transactions status to confirmed thhose are about to be added to a new block that are going to be added to the blockchain
-    */
-    for (auto &tx : mempool)
-    {
-        // deduct from sender
-        walletManager.updateBalance(tx.sender, -tx.amount);
+// -----------------------------------------------------------
+//  Mine a block from the highest-priority mempool transactions
+//  (within UMA_BLOCK_MAX_TX / UMA_BLOCK_MAX_BYTES); the rest
+//  stay in the mempool for the next block
+// -----------------------------------------------------------
 
-        // credit receiver
-        walletManager.updateBalance(tx.receiver, tx.amount);
+bool Blockchain::minePendingTransactions(const std::string &minerAddress, WalletManager &walletManager)
+{
+    std::lock_guard<std::mutex> minerLock(minerMutex); // one miner at a time
 
-        tx.status = TxStatus::CONFIRMED;
+    {
+        std::unique_lock<std::shared_mutex> lock(stateMutex);
+        expireMempool();
     }
 
-    Block newBlock(newIndex, timestr, mempool, getLatestBlock().hash);
+    while (true)
+    {
+        // 1. take the ready template (header fields + mempool transactions)
+        BlockTemplate work = templates.snapshot();
+        if (work.transactions.empty())
+        {
+            LOG_INFO("no pending transactions to mine");
+            return false;
+        }
 
-    // 3. Perform PoW, Mine the block
-    newBlock.mineBlock(difficulty);
+        std::vector<Transaction> txs = work.transactions;
+        for (auto &tx : txs)
+            tx.status = TxStatus::CONFIRMED;
 
-    // 4. Add block to chain
-    chain.push_back(newBlock);
+        // 2. Add block reward (free coins from system) plus the fees of included transactions
+        Transaction rewardTx("SYSTEM", minerAddress, miningReward + work.totalFees);
+        rewardTx.status = TxStatus::CONFIRMED;
+        txs.push_back(rewardTx);
 
-    // 5. Clear mempool
-    mempool.clear();
+        Block newBlock(work.index, currentTimestamp(), txs, work.previousHash);
 
-    // save updated chain to file
-    saveToFile();
+        // 3. Perform PoW; drop the attempt if a fresher template is worth switching to,
+        //    so transactions that arrive while mining make it into this block
+        if (!sealBlock(newBlock, [&]()
+                       { return templates.shouldRestart(work); }))
+            continue;
 
-    return true; // block mined successfully
+        // 4. Commit: apply balances, append, take mined txs out of the mempool
+        std::vector<EventHub::Prepared> sealed;
+        if (events)
+            sealed = blockEvents(newBlock);
+        WalletManager::Snapshot wallets;
+        {
+            std::unique_lock<std::shared_mutex> lock(stateMutex);
+            if (chain->tip().hash != work.previousHash)
+                continue; // tip moved between solving and committing
+            if (!mempool.containsAll(work.transactions))
+                continue; // some of the work was evicted or expired while we were mining
+
+            // sender pays amount + fee (the fee reaches the miner through the reward tx);
+            // one wallet lock for the whole block, the file is written after the commit
+            wallets = walletManager.applyTransfers(newBlock.transactions);
+
+            // published before the mempool drops the txs: a reader that misses them in the
+            // mempool is guaranteed to find them in the chain
+            appendBlock(newBlock);
+            difficulty.recordBlock(newBlock.target, newBlock.solveTimeMs);
+
+            mempool.remove(work.transactions); // leftovers carry over to the next block
+            refreshTemplate(true);
+
+            if (events)
+                events->publish(std::move(sealed));
+        }
+
+        // save updated wallets and chain (outside the exclusive lock)
+        walletManager.save(wallets);
+        saveToFile();
+
+        return true; // block mined successfully
+    }
 }
 
 double Blockchain::getBalance(const std::string &walletAddress)
+{
+    return confirmedBalance(*snapshot(), walletAddress);
+}
+
+double Blockchain::confirmedBalance(const ChainSnapshot &chain, const std::string &walletAddress)
 {
     double balance = 0.0;
 
     // Go through every block
-    for (const auto &block : chain)
+    for (const auto &block : chain.blocks)
     {
         // Go through each transaction
-        for (const auto &tx : block.transactions)
+        for (const auto &tx : block->transactions)
         {
             if (tx.sender == walletAddress)
             {
-                balance -= tx.amount;
+                balance -= tx.amount + tx.fee;
             }
             if (tx.receiver == walletAddress)
             {
@@ -131,31 +418,29 @@ double Blockchain::getBalance(const std::string &walletAddress)
 
 double Blockchain::getEffectiveBalance(const std::string &wallet)
 {
-    double confirmed = getBalance(wallet);
-    double pendingOut = 0;
-
-    for (const Transaction &tx : mempool)
-    {
-        if (tx.sender == wallet)
-        {
-            pendingOut += tx.amount;
-        }
-    }
+    // chain and mempool read under one shared lock so a block commit can't land in between
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    double confirmed = confirmedBalance(*chain, wallet);
+    double pendingOut = mempool.pendingOutflow(wallet) + reservedFor(wallet); // sender index, no mempool scan
 
-    std::cout << "confirmed : " << confirmed << std::endl;
-    std::cout << "pending out : " << pendingOut << std::endl;
-    std::cout << "confirmed - pendingOut = " << confirmed - pendingOut << std::endl;
+    LOG_DEBUG("effective balance", {"wallet", wallet}, {"confirmed", confirmed}, {"pendingOut", pendingOut});
 
     return confirmed - pendingOut;
 }
 
+double Blockchain::reservedFor(const std::string &wallet) const
+{
+    auto it = reservedOutflow.find(wallet);
+    return it == reservedOutflow.end() ? 0 : it->second;
+}
+
 bool Blockchain::validateTransaction(const Transaction &tx)
 {
     double effective = getEffectiveBalance(tx.sender);
 
-    if (effective < tx.amount)
+    if (effective < tx.amount + tx.fee)
     {
-        std::cerr << "Rejected: double-spend attempt (insufficient effective funds)\n";
+        LOG_INFO("rejected: insufficient effective funds", {"sender", tx.sender}, {"amount", tx.amount}, {"available", effective});
         return false;
     }
 
@@ -168,16 +453,31 @@ bool Blockchain::validateTransaction(const Transaction &tx)
 
 bool Blockchain::isValidChain()
 {
-    for (size_t i = 1; i < chain.size(); i++)
+    ChainView chain = snapshot();
+    Difficulty schedule(difficulty.targetBlockMs(), difficulty.windowSize());
+    if (!chain->empty() && !schedule.follow((*chain)[0].target, (*chain)[0].solveTimeMs))
+        return false;
+
+    for (size_t i = 1; i < chain->size(); i++)
     {
-        Block current = chain[i];
-        Block previous = chain[i - 1];
+        const Block &current = (*chain)[i];
+        const Block &previous = (*chain)[i - 1];
+
+        if (!schedule.follow(current.target, current.solveTimeMs))
+        {
+            return false;
+        }
 
         if (current.hash != current.calculateHash())
         {
             return false;
         }
 
+        if (!current.meetsTarget())
+        {
+            return false;
+        }
+
         if (current.previousHash != previous.hash)
         {
             return false;
@@ -187,6 +487,18 @@ bool Blockchain::isValidChain()
     return true;
 }
 
+bool Blockchain::isValidChain(WalletManager &walletManager)
+{
+    return revalidate(walletManager).valid;
+}
+
+ValidationReport Blockchain::revalidate(WalletManager &walletManager, ValidationProgress *progress)
+{
+    // validate a snapshot so mining isn't held up for the whole run
+    ChainValidator validator(difficulty.targetBlockMs(), difficulty.windowSize());
+    return validator.validate(*snapshot(), &walletManager, progress);
+}
+
 // -----------------------------
 //    Save chain to a .json file
 // -----------------------------
@@ -197,18 +509,19 @@ void Blockchain::saveToFile()
 
 void Blockchain::saveToJSON()
 {
-    nlohmann::json jChain = nlohmann::json::array();
+    // serialize a snapshot without any lock; the version keeps an older snapshot from
+    // overwriting a newer one when two saves race
+    ChainView view = snapshot();
+    std::string data = view->jsonArray(0, view->size()); // cached per-block JSON, compact
 
-    for (const auto &block : chain)
-        jChain.push_back(block.toJSON());
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    if (view->version < savedVersion)
+        return;
+    savedVersion = view->version;
 
-    std::ofstream file("../data/blockchain.json");
-    file << jChain.dump(4); // pretty print JSON
+    Persist::writeFile("../data/blockchain.json", data, "blockchain");
 }
 
-// -----------------------------
-//     Load chain from .json file
-// -----------------------------
 void Blockchain::loadFromFile()
 {
     loadFromJSON();
@@ -223,30 +536,10 @@ void Blockchain::loadFromJSON()
     nlohmann::json jChain;
     file >> jChain;
 
-    chain.clear();
+    auto loaded = std::make_shared<ChainSnapshot>();
     for (auto &jBlock : jChain)
-    {
-        int index = jBlock["index"];
-        std::string timestamp = jBlock["timestamp"];
-        std::string prevHash = jBlock["previousHash"];
-        std::string hash = jBlock["hash"];
-
-        std::vector<Transaction> txs;
-        for (auto &jTx : jBlock["transactions"])
-        {
-            Transaction tx(
-                jTx["sender"],
-                jTx["receiver"],
-                jTx["amount"]);
-            tx.status = (TxStatus)jTx["status"];
-            txs.push_back(tx);
-        }
-
-        Block block(index, timestamp, txs, prevHash);
-        block.hash = hash;
-
-        chain.push_back(block);
-    }
+        loaded->push(std::make_shared<const Block>(Block::fromJSON(jBlock)), compressLevel); // keeps nonce, target and tx ids as persisted
+    chain = std::move(loaded);
 }
 
 // ================================
@@ -254,9 +547,10 @@ void Blockchain::loadFromJSON()
 // ================================
 std::vector<Block> Blockchain::getBlocks(int limit, int offset)
 {
+    ChainView chain = snapshot();
     std::vector<Block> result;
 
-    int total = chain.size();
+    int total = chain->size();
     if (offset >= total)
         return result;
 
@@ -264,7 +558,7 @@ std::vector<Block> Blockchain::getBlocks(int limit, int offset)
 
     for (int i = offset; i < end; i++)
     {
-        result.push_back(chain[i]);
+        result.push_back((*chain)[i]);
     }
     return result;
 }
@@ -274,10 +568,39 @@ std::vector<Block> Blockchain::getBlocks(int limit, int offset)
 // ================================
 Block Blockchain::getBlockByIndex(int index)
 {
-    if (index < 0 || index >= (int)chain.size())
+    ChainView chain = snapshot();
+    if (index < 0 || index >= (int)chain->size())
         throw std::runtime_error("Block index out of range");
 
-    return chain[index];
+    return (*chain)[index];
+}
+
+// A block commit publishes the new chain before removing its txs from the mempool, so a tx is
+// never missed by reading the mempool first, but one mined in between can show up in both.
+static void dropConfirmed(std::vector<Transaction> &pending, const std::string &txid)
+{
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [&](const Transaction &p) { return p.id == txid; }),
+                  pending.end());
+}
+
+std::vector<Transaction> Blockchain::pendingForWallet(const std::string &walletId, ChainView &chain)
+{
+    ChainView before = snapshot();
+    std::vector<Transaction> pending;
+    mempool.forEach([&](const Transaction &tx)
+                    {
+        if (tx.sender == walletId || tx.receiver == walletId)
+            pending.push_back(tx); });
+    chain = snapshot();
+
+    // a tx both pending and mined sits in a block published while it was still in the
+    // mempool: before's tip (removal still in flight) or anything appended since
+    for (size_t i = before->size() - 1; i < chain->size() && !pending.empty(); i++)
+        for (const auto &tx : (*chain)[i].transactions)
+            dropConfirmed(pending, tx.id);
+
+    return pending;
 }
 
 // ================================
@@ -285,16 +608,13 @@ Block Blockchain::getBlockByIndex(int index)
 // ================================
 std::vector<Transaction> Blockchain::getTransactionsForWallet(const std::string &walletId)
 {
-    std::vector<Transaction> out;
     // mempool pending transactions first (optional)
-    for (const auto &tx : mempool)
-    {
-        if (tx.sender == walletId || tx.receiver == walletId)
-            out.push_back(tx);
-    }
-    for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+    ChainView chain;
+    std::vector<Transaction> out = pendingForWallet(walletId, chain);
+
+    for (auto it = chain->blocks.rbegin(); it != chain->blocks.rend(); ++it)
     {
-        for (const auto &tx : it->transactions)
+        for (const auto &tx : (*it)->transactions)
         {
             if (tx.sender == walletId || tx.receiver == walletId)
                 out.push_back(tx);
@@ -308,11 +628,14 @@ std::vector<Transaction> Blockchain::getTransactionsForWallet(const std::string
 // ================================
 Transaction Blockchain::getTransactionById(const std::string &txid)
 {
-    for (const auto &tx : mempool)
-        if (tx.id == txid)
-            return tx;
-    for (const auto &block : chain)
-        for (const auto &tx : block.transactions)
+    Transaction pending;
+    if (mempool.find(txid, pending))
+        return pending;
+
+    // loaded after the mempool lookup, so a tx mined meanwhile is already in it
+    ChainView chain = snapshot();
+    for (const auto &block : chain->blocks)
+        for (const auto &tx : block->transactions)
             if (tx.id == txid)
                 return tx;
     return Transaction(); // empty
@@ -323,50 +646,101 @@ Transaction Blockchain::getTransactionById(const std::string &txid)
 // ================================
 std::vector<Transaction> Blockchain::getLatestTransactions(int limit)
 {
+    std::vector<Transaction> pending;
+    mempool.forEach([&](const Transaction &tx)
+                    {
+        if ((int)pending.size() < limit)
+            pending.push_back(tx); });
+
+    ChainView chain = snapshot();
     std::vector<Transaction> out;
-    for (auto it = chain.rbegin(); it != chain.rend() && (int)out.size() < limit; ++it)
-        for (const auto &tx : it->transactions)
+    for (auto it = chain->blocks.rbegin(); it != chain->blocks.rend() && (int)out.size() < limit; ++it)
+        for (const auto &tx : (*it)->transactions)
         {
+            if (!pending.empty())
+                dropConfirmed(pending, tx.id);
             out.push_back(tx);
             if ((int)out.size() >= limit)
                 break;
         }
     // optionally add mempool at front
-    for (const auto &tx : mempool)
+    for (const auto &tx : pending)
     {
         if ((int)out.size() >= limit)
             break;
-        out.insert(out.begin(), tx); // pending at top
+        out.insert(out.begin(), tx); /* pending at top */
     }
     return out;
 }
 
 void Blockchain::addConfirmedTransaction(const Transaction &tx)
+{
+    commitConfirmed(tx, 0);
+}
+
+bool Blockchain::addConfirmedDebit(const Transaction &tx, WalletManager &walletManager)
+{
+    WalletManager::Snapshot wallets;
+    {
+        std::unique_lock<std::shared_mutex> lock(stateMutex);
+        double effective = confirmedBalance(*chain, tx.sender) - mempool.pendingOutflow(tx.sender) - reservedFor(tx.sender);
+        if (effective < tx.amount)
+        {
+            LOG_INFO("rejected: insufficient effective funds", {"sender", tx.sender}, {"amount", tx.amount}, {"available", effective});
+            return false;
+        }
+
+        // held until the block lands, so nothing else can spend it while the PoW runs
+        reservedOutflow[tx.sender] += tx.amount;
+        wallets = walletManager.adjustBalance(tx.sender, -tx.amount);
+    }
+    walletManager.save(wallets);
+
+    commitConfirmed(tx, tx.amount);
+    return true;
+}
+
+void Blockchain::commitConfirmed(const Transaction &tx, double reserved)
 {
     // create a copy of the transaction and ensure it's marked confirmed
     Transaction txCopy = tx;
     txCopy.status = TxStatus::CONFIRMED;
 
-    int newIndex = chain.size();
-    time_t now = time(0);
-    std::string timestr = ctime(&now);
-    while (!timestr.empty() && (timestr.back() == '\n' || timestr.back() == '\r'))
-        timestr.pop_back();
-
     // make a block with just this transaction
     std::vector<Transaction> txs;
     txs.push_back(txCopy);
 
-    Block newBlock(newIndex, timestr, txs, getLatestBlock().hash);
+    // block producers take turns: nothing else can append while this one is sealed, so each
+    // confirmation costs exactly one PoW and is never thrown away for a moved tip
+    std::lock_guard<std::mutex> minerLock(minerMutex);
+
+    ChainView tip = snapshot();
+    Block newBlock(tip->size(), currentTimestamp(), txs, tip->tip().hash);
+
+    // same PoW target as regular blocks so block production rate doesn't depend on which path made the block
+    sealBlock(newBlock);
+
+    std::vector<EventHub::Prepared> sealed;
+    if (events)
+        sealed = blockEvents(newBlock);
+
+    // Add block, save; the next miner run starts from the new tip
+    {
+        std::unique_lock<std::shared_mutex> lock(stateMutex);
+        appendBlock(newBlock);
+        difficulty.recordBlock(newBlock.target, newBlock.solveTimeMs);
+        refreshTemplate(true);
 
-    // Mine with zero difficulty so it produces a hash without looping (fast and deterministic)
-    // Backup current difficulty and restore after if you want; here we set difficulty 0 for this block
-    int savedDifficulty = difficulty;
-    newBlock.mineBlock(0); // or use difficulty=0 to skip pow
-    // restore difficulty if your code uses global difficulty
-    difficulty = savedDifficulty;
+        // the debit is in the chain now, stop counting it twice
+        if (reserved > 0)
+        {
+            auto it = reservedOutflow.find(txCopy.sender);
+            if (it != reservedOutflow.end() && (it->second -= reserved) <= 1e-12)
+                reservedOutflow.erase(it);
+        }
 
-    // Add block, save
-    chain.push_back(newBlock);
+        if (events)
+            events->publish(std::move(sealed));
+    }
     saveToFile();
-}
\ No newline at end of file
+}
@@ -3,24 +3,85 @@
 
 #include <vector>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
+#include <functional>
+#include <unordered_map>
 #include "../block/Block.h"
 #include "../transaction/Transaction.h"
 #include "../wallet/WalletManager.h"
+#include "../mining/Difficulty.h"
+#include "../mining/BlockTemplate.h"
+#include "../mempool/Mempool.h"
+#include "ChainSnapshot.h"
+#include "ChainValidator.h"
+
+class EventHub;
 
 class Blockchain
 {
 private:
-    std::vector<Block> chain;
-    std::vector<Transaction> mempool; // unconfirmed transactions
-    int difficulty;
+    ChainView chain;                  // current snapshot; replaced (never modified) on append
+    Mempool mempool;                  // unconfirmed transactions, priority ordered
+    Difficulty difficulty;            // retargets toward UMA_TARGET_BLOCK_MS; the schedule is a chain rule (see Difficulty::follow)
+    BlockTemplateBuilder templates;   // next block to mine, kept in sync with mempool and tip
     double miningReward;
+    int compressLevel; // block groups are compressed once, so spend the CPU (UMA_COMPRESS_CACHED_LEVEL)
+
+    // Locking. Chain readers (balances, lookups, block listings) never take stateMutex: they
+    // load the published ChainView and work on that. Mempool admission, block commit and
+    // expiry take stateMutex exclusive; checks that must see chain and mempool together
+    // (effective balance) take it shared. Lock order:
+    //     minerMutex -> stateMutex -> Mempool / BlockTemplateBuilder internals
+    //                -> WalletManager::mtx -> KeyCache
+    // Never take stateMutex while holding a WalletManager lock. Nothing slow (PoW, file
+    // writes, signature checks) runs under the exclusive lock.
+    mutable std::shared_mutex stateMutex; // guards chain, mempool membership and the retarget window
+    std::mutex minerMutex;                // one block producer at a time (miner, confirmed txs)
+    std::mutex fileMutex;                 // serializes writes of blockchain.json
+    uint64_t savedVersion = 0;            // newest snapshot on disk, under fileMutex
+
+    // debits taken by addConfirmedDebit whose block isn't appended yet; counted against the
+    // sender like pending mempool txs (under stateMutex)
+    std::unordered_map<std::string, double> reservedOutflow;
+
+    mutable std::mutex walletVersionMutex;                  // leaf lock, held for one map access
+    std::unordered_map<std::string, uint64_t> walletVersions; // wallet -> chain version of the last block touching it
+
+    // SSE fan-out. Events are rendered before stateMutex is taken and handed to the hub inside
+    // the commit that caused them, so event ids follow commit order (admitted before confirmed,
+    // blocks in chain order); the hub only takes its own leaf lock
+    EventHub *events = nullptr;
+
+    // run PoW against the current target and record the solve time; false if shouldStop fired
+    bool sealBlock(Block &block, const std::function<bool()> &shouldStop = nullptr);
+    // rebuild the template from the tip and mempool priority order (stateMutex held);
+    // invalidate stops miners still working on an older template
+    void refreshTemplate(bool invalidate);
+    void expireMempool(); // drop TTL-expired transactions (stateMutex held)
+    // publish a snapshot with block appended (stateMutex exclusive); the tip readers see moves here
+    void appendBlock(const Block &block);
+    static double confirmedBalance(const ChainSnapshot &chain, const std::string &walletAddress);
+    double reservedFor(const std::string &wallet) const; // reservedOutflow lookup (stateMutex held)
+    // seal tx into its own block and append it; releases `reserved` of the sender's reservation
+    // in the same commit that puts the debit in the chain
+    void commitConfirmed(const Transaction &tx, double reserved);
+    void restoreDifficulty();     // rebuild the retarget window from the loaded chain
+    void registerMetrics();       // chain / mempool gauges for /metrics
 
 public:
     Blockchain();
 
+    void setEventHub(EventHub *hub) { events = hub; } // set before serving, cleared before the hub goes away
+
     Block createGenesisBlock();
 
-    void addTransaction(const Transaction &tx); // add transaction to mempool for mining
+    Mempool::AddResult addTransaction(const Transaction &tx); // add transaction to mempool for mining
+
+    // balance check and insert as one step, for a whole batch under one chain and one mempool lock;
+    // results[i] is for txs[i], REFUSED = sender can't cover amount + fee (pending txs included)
+    std::vector<Mempool::AddResult> admitTransactions(const std::vector<Transaction> &txs);
 
     Block getLatestBlock();
 
@@ -33,12 +94,32 @@ public:
     bool validateTransaction(const Transaction &tx);
 
     bool isValidChain();
+    bool isValidChain(WalletManager &walletManager); // full revalidate(): signatures and balances too
+
+    // two-stage ChainValidator run over a snapshot of the chain; progress (optional) is updated live
+    ValidationReport revalidate(WalletManager &walletManager, ValidationProgress *progress = nullptr);
+
+    uint64_t getTarget() const { return difficulty.currentTarget(); }
+
+    double getDifficulty() const { return difficulty.currentDifficulty(); }
+
+    long long getTargetBlockMs() const { return difficulty.targetBlockMs(); }
+
+    // current chain version; no allocation, just a refcount bump. Not lock-free: libstdc++
+    // implements atomic_load/atomic_store on shared_ptr with a small global pool of mutexes,
+    // held only for the pointer copy, so it never waits behind stateMutex or a block commit
+    ChainView snapshot() const { return std::atomic_load(&chain); }
 
-    std::vector<Block> getChain() { return chain; };
+    // chain version of the last block that moved walletId's balance (0 = none since startup);
+    // updated just after that block is published, so read it before reading the chain
+    uint64_t walletVersion(const std::string &walletId) const;
 
-    std::vector<Transaction> getMempool() { return mempool; };
+    const Mempool &getMempool() const { return mempool; };
 
     std::vector<Transaction> getTransactionsForWallet(const std::string &walletId);
+    // walletId's pending txs (priority order) and, in chain, the snapshot holding its confirmed ones;
+    // together they cover each tx exactly once
+    std::vector<Transaction> pendingForWallet(const std::string &walletId, ChainView &chain);
 
     Transaction getTransactionById(const std::string &txid);
 
@@ -49,6 +130,10 @@ public:
     std::vector<Block> getBlocks(int limit = 100, int offset = 0);
     
     void addConfirmedTransaction(const Transaction &tx);
+    // funds check, wallet debit of tx.amount and reservation as one step under stateMutex exclusive,
+    // then tx is recorded like addConfirmedTransaction; false (nothing changed) if the sender's
+    // effective balance can't cover it
+    bool addConfirmedDebit(const Transaction &tx, WalletManager &walletManager);
 
     void saveToFile();
     void loadFromFile();
@@ -0,0 +1,78 @@
+#ifndef CHAIN_SNAPSHOT_H
+#define CHAIN_SNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../block/Block.h"
+#include "../codec/Deflate.h"
+
+// Immutable view of the chain as of one version. Blocks are shared between consecutive
+// snapshots, so publishing after an append copies pointers, never blocks. A request that
+// holds one ChainView sees the same chain for its whole lifetime, whatever gets mined meanwhile.
+// Sealed blocks never change, so each one is serialized to compact JSON once (at append or
+// load) and explorer responses are stitched together from those bytes. Every full group of
+// GROUP_BLOCKS blocks is also compressed once, for gzip/deflate responses.
+struct ChainSnapshot
+{
+    static constexpr size_t GROUP_BLOCKS = 64;
+
+    uint64_t version = 0; // bumped on every publish
+    std::vector<std::shared_ptr<const Block>> blocks;
+    std::vector<std::shared_ptr<const std::string>> blockJSON; // blockJSON[i] = blocks[i].toJSON().dump()
+    // groupDeflate[g] = ",<block 64g>,...,<block 64g+63>" as a spliceable deflate segment
+    std::vector<std::shared_ptr<const DeflateSegment>> groupDeflate;
+
+    // append a block together with its serialized form; completing a group compresses it at level
+    void push(std::shared_ptr<const Block> block, int level)
+    {
+        blockJSON.push_back(std::make_shared<const std::string>(block->toJSON().dump()));
+        blocks.push_back(std::move(block));
+
+        if (blocks.size() % GROUP_BLOCKS == 0)
+        {
+            std::string raw;
+            for (size_t i = blocks.size() - GROUP_BLOCKS; i < blocks.size(); i++)
+            {
+                raw.push_back(',');
+                raw.append(*blockJSON[i]);
+            }
+            auto seg = std::make_shared<DeflateSegment>();
+            Deflate::segment(raw.data(), raw.size(), level, *seg);
+            groupDeflate.push_back(std::move(seg));
+        }
+    }
+
+    size_t size() const { return blocks.size(); }
+    bool empty() const { return blocks.empty(); }
+    const Block &operator[](size_t i) const { return *blocks[i]; }
+    const Block &tip() const { return *blocks.back(); }
+    const std::string &json(size_t i) const { return *blockJSON[i]; }
+
+    // "[<block begin>,...,<block end-1>]" from the cached bytes; no JSON is built
+    std::string jsonArray(size_t begin, size_t end) const
+    {
+        end = std::min(end, blocks.size());
+        size_t bytes = 2;
+        for (size_t i = begin; i < end; i++)
+            bytes += blockJSON[i]->size() + 1;
+
+        std::string out;
+        out.reserve(bytes);
+        out.push_back('[');
+        for (size_t i = begin; i < end; i++)
+        {
+            if (i > begin)
+                out.push_back(',');
+            out.append(*blockJSON[i]);
+        }
+        out.push_back(']');
+        return out;
+    }
+};
+
+using ChainView = std::shared_ptr<const ChainSnapshot>;
+
+#endif
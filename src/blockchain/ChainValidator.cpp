@@ -0,0 +1,299 @@
+#include "ChainValidator.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "../config/Config.h"
+#include "../crypto/Crypto.h"
+#include "../crypto/VerifyService.h"
+#include "../log/Logger.h"
+
+static const size_t CHUNK_BLOCKS = 32;      // blocks a worker claims at a time
+static const double BALANCE_EPSILON = 1e-9; // float dust from fee arithmetic
+
+static long long steadyNowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+nlohmann::json ValidationProgress::toJSON() const
+{
+    static const char *STAGES[] = {"idle", "blocks", "balances", "done"};
+    long long end = finishedMs.load() ? finishedMs.load() : steadyNowMs();
+    long long elapsed = startedMs.load() ? end - startedMs.load() : 0;
+    size_t checked = blocksChecked.load();
+
+    return {
+        {"stage", STAGES[stage.load()]},
+        {"totalBlocks", totalBlocks.load()},
+        {"blocksChecked", checked},
+        {"blocksReplayed", blocksReplayed.load()},
+        {"elapsedMs", elapsed},
+        {"blocksPerSec", elapsed > 0 ? checked * 1000.0 / elapsed : 0.0},
+    };
+}
+
+nlohmann::json ValidationReport::toJSON() const
+{
+    nlohmann::json j = {
+        {"valid", valid},
+        {"blocks", blocks},
+        {"transactions", transactions},
+        {"signatures", signatures},
+        {"elapsedMs", elapsedMs},
+        {"blocksPerSec", blocksPerSec},
+    };
+    if (!valid)
+    {
+        j["failedBlock"] = failedBlock;
+        j["reason"] = reason;
+    }
+    return j;
+}
+
+ChainValidator::ChainValidator(long long targetBlockMs, size_t retargetWindow, unsigned threads)
+    : targetBlockMs(targetBlockMs), retargetWindow(retargetWindow)
+{
+    if (threads == 0)
+        threads = (unsigned)Config::getInt("UMA_VALIDATE_THREADS", std::thread::hardware_concurrency());
+    this->threads = threads > 0 ? threads : 1;
+}
+
+bool ChainValidator::isIssuer(const std::string &account)
+{
+    return account == "SYSTEM" || account == "FIAT";
+}
+
+namespace
+{
+    // first failure wins by block index, so the report doesn't depend on thread timing
+    struct FirstFailure
+    {
+        std::mutex mtx;
+        std::atomic<long long> index{-1};
+        std::string reason;
+
+        void record(long long blockIndex, const std::string &why)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            long long current = index.load();
+            if (current == -1 || blockIndex < current)
+            {
+                index = blockIndex;
+                reason = why;
+            }
+        }
+
+        // blocks after a known failure don't need checking
+        bool beyond(size_t blockIndex) const
+        {
+            long long current = index.load(std::memory_order_relaxed);
+            return current != -1 && (long long)blockIndex > current;
+        }
+    };
+
+    struct SenderKey
+    {
+        std::shared_ptr<EVP_PKEY> key;
+        std::string keyId;
+    };
+
+    // a tx is checked against the key recorded with it (the one active when it was admitted),
+    // which must be a key the sender was actually bound to; only txs from before keys were
+    // recorded fall back to the sender's current key
+    std::string keySlot(const Transaction &tx)
+    {
+        return tx.signerKey.empty() ? "wallet:" + tx.sender : "key:" + tx.signerKey;
+    }
+
+    std::string bindingOf(const Transaction &tx)
+    {
+        return tx.sender + "\n" + tx.signerKey;
+    }
+
+    // the only txs recorded without a signature: issuer mints (rewards, /buy) and /sell's off-ramp
+    bool mayBeUnsigned(const Transaction &tx)
+    {
+        return ChainValidator::isIssuer(tx.sender) || tx.receiver == "FIAT";
+    }
+}
+
+ValidationReport ChainValidator::validate(const ChainSnapshot &chain, WalletManager *wallets,
+                                          ValidationProgress *progress)
+{
+    ValidationProgress local;
+    ValidationProgress &prog = progress ? *progress : local;
+    prog.totalBlocks = chain.size();
+    prog.blocksChecked = 0;
+    prog.blocksReplayed = 0;
+    prog.startedMs = steadyNowMs();
+    prog.finishedMs = 0;
+    prog.stage = ValidationProgress::BLOCKS;
+
+    ValidationReport report;
+    report.blocks = chain.size();
+    auto started = std::chrono::steady_clock::now();
+
+    // resolve keys up front on this thread: WalletManager isn't safe to read from the workers,
+    // the parsed keys are (see KeyCache)
+    std::unordered_map<std::string, SenderKey> keys;
+    std::unordered_map<std::string, bool> bound; // bindingOf(tx) -> signerKey was bound to the sender
+    if (wallets)
+    {
+        for (const auto &block : chain.blocks)
+            for (const auto &tx : block->transactions)
+            {
+                if (!tx.isSigned())
+                    continue;
+                if (!tx.signerKey.empty() && !bound.count(bindingOf(tx)))
+                    bound[bindingOf(tx)] = wallets->wasKeyBound(tx.sender, tx.signerKey);
+
+                std::string slot = keySlot(tx);
+                if (keys.count(slot))
+                    continue;
+
+                SenderKey &sk = keys[slot];
+                if (tx.signerKey.empty())
+                {
+                    sk.key = wallets->getVerifyKey(tx.sender, &sk.keyId);
+                    continue;
+                }
+                CompactPublicKey compact;
+                if (Crypto::compactKeyFromString(tx.signerKey, compact))
+                    sk.key = Crypto::publicKeyFromCompact(compact);
+                if (sk.key)
+                    sk.keyId = Crypto::publicKeyFingerprint(sk.key.get());
+            }
+    }
+
+    // blocks from before retargeting also predate signed admission; unsigned transfers are
+    // accepted there only, like their MAX_TARGET (see Difficulty::follow)
+    size_t legacyEnd = 0;
+    while (legacyEnd < chain.size() && chain[legacyEnd].target == Difficulty::MAX_TARGET)
+        legacyEnd++;
+
+    // ---- stage 1: independent per-block checks, in parallel ----
+    FirstFailure failure;
+    std::atomic<size_t> cursor{0};
+    std::atomic<size_t> signatures{0};
+
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            size_t begin = cursor.fetch_add(CHUNK_BLOCKS);
+            if (begin >= chain.size())
+                return;
+            size_t end = std::min(begin + CHUNK_BLOCKS, chain.size());
+
+            for (size_t i = begin; i < end && !failure.beyond(i); i++)
+            {
+                const Block &block = chain[i];
+
+                if (block.hash != block.calculateHash())
+                    failure.record(i, "hash mismatch");
+                else if (i > 0 && !block.meetsTarget())
+                    failure.record(i, "hash does not meet target");
+                else if (i > 0 && block.previousHash != chain[i - 1].hash)
+                    failure.record(i, "previousHash does not link to block " + std::to_string(i - 1));
+                else if (wallets)
+                {
+                    for (const auto &tx : block.transactions)
+                    {
+                        if (!tx.isSigned())
+                        {
+                            if (i >= legacyEnd && !mayBeUnsigned(tx))
+                            {
+                                failure.record(i, "unsigned transfer tx " + tx.id);
+                                break;
+                            }
+                            continue;
+                        }
+                        signatures.fetch_add(1, std::memory_order_relaxed);
+
+                        auto binding = tx.signerKey.empty() ? bound.end() : bound.find(bindingOf(tx)); // read-only here
+                        if (!tx.signerKey.empty() && (binding == bound.end() || !binding->second))
+                        {
+                            failure.record(i, "tx " + tx.id + " signed with a key never bound to " + tx.sender);
+                            break;
+                        }
+
+                        auto it = keys.find(keySlot(tx));
+                        if (!tx.matchesSignedMessage() || it == keys.end() || !it->second.key ||
+                            !VerifyService::verifyNow({it->second.key, tx.signedMessage, tx.signatureBase64, it->second.keyId}))
+                        {
+                            failure.record(i, "invalid signature on tx " + tx.id);
+                            break;
+                        }
+                    }
+                }
+
+                prog.blocksChecked.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    unsigned n = (unsigned)std::min<size_t>(threads, (chain.size() + CHUNK_BLOCKS - 1) / CHUNK_BLOCKS);
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < n; t++)
+        pool.emplace_back(worker);
+    worker(); // this thread takes a share too
+    for (auto &th : pool)
+        th.join();
+
+    report.signatures = signatures.load();
+    LOG_INFO("revalidation: blocks checked", {"blocks", chain.size()}, {"signatures", report.signatures},
+             {"threads", n}, {"ms", steadyNowMs() - prog.startedMs.load()});
+
+    // ---- stage 2: sequential balance replay (only over the prefix that passed stage 1) ----
+    prog.stage = ValidationProgress::BALANCES;
+    size_t replayEnd = failure.index == -1 ? chain.size() : (size_t)failure.index.load();
+
+    Difficulty schedule(targetBlockMs, retargetWindow);
+    std::unordered_map<std::string, double> balances;
+    for (size_t i = 0; i < replayEnd; i++)
+    {
+        if (!schedule.follow(chain[i].target, chain[i].solveTimeMs))
+        {
+            failure.record(i, "target is not the one the retarget schedule requires");
+            break;
+        }
+
+        bool overdrawn = false;
+        for (const auto &tx : chain[i].transactions)
+        {
+            report.transactions++;
+            double &from = balances[tx.sender];
+            from -= tx.amount + tx.fee;
+            if (!isIssuer(tx.sender) && from < -BALANCE_EPSILON)
+            {
+                failure.record(i, "balance of " + tx.sender + " goes negative in tx " + tx.id);
+                overdrawn = true;
+                break;
+            }
+            balances[tx.receiver] += tx.amount;
+        }
+        if (overdrawn)
+            break;
+        prog.blocksReplayed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    report.valid = failure.index == -1;
+    report.failedBlock = failure.index;
+    report.reason = failure.reason;
+    report.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    report.blocksPerSec = report.elapsedMs > 0 ? chain.size() * 1000.0 / report.elapsedMs : 0;
+    prog.finishedMs = steadyNowMs();
+    prog.stage = ValidationProgress::DONE;
+
+    if (report.valid)
+        LOG_INFO("revalidation: chain valid", {"blocks", report.blocks}, {"transactions", report.transactions},
+                 {"ms", report.elapsedMs}, {"blocksPerSec", report.blocksPerSec});
+    else
+        LOG_ERROR("revalidation: chain invalid", {"block", report.failedBlock}, {"reason", report.reason});
+
+    return report;
+}
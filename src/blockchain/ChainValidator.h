@@ -0,0 +1,74 @@
+#ifndef CHAIN_VALIDATOR_H
+#define CHAIN_VALIDATOR_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "../block/Block.h"
+#include "../mining/Difficulty.h"
+#include "ChainSnapshot.h"
+#include "../wallet/WalletManager.h"
+#include "../../include/json.hpp"
+
+// Live counters of a running validation; safe to read from other threads (admin endpoint)
+struct ValidationProgress
+{
+    enum Stage
+    {
+        IDLE,
+        BLOCKS,   // parallel: hash, PoW target, previousHash link, signatures
+        BALANCES, // sequential replay: retarget schedule and balances
+        DONE
+    };
+
+    std::atomic<int> stage{IDLE};
+    std::atomic<size_t> totalBlocks{0};
+    std::atomic<size_t> blocksChecked{0};
+    std::atomic<size_t> blocksReplayed{0};
+    std::atomic<long long> startedMs{0};  // steady clock
+    std::atomic<long long> finishedMs{0}; // 0 while running
+
+    nlohmann::json toJSON() const; // includes elapsed time and blocks/sec so far
+};
+
+struct ValidationReport
+{
+    bool valid = true;
+    long long failedBlock = -1; // lowest failing block index
+    std::string reason;
+    size_t blocks = 0;
+    size_t transactions = 0;
+    size_t signatures = 0;
+    double elapsedMs = 0;
+    double blocksPerSec = 0;
+
+    nlohmann::json toJSON() const;
+};
+
+// Two-stage revalidation of a chain:
+//   1. blocks are checked in parallel (chunks handed out through an atomic cursor):
+//      hash == calculateHash(), meetsTarget(), previousHash link and every signature (made
+//      with a key bound to the sender; only issuer and off-ramp txs may be unsigned)
+//   2. a sequential replay in chain order: every block's target must be the one the retarget
+//      schedule gives from the blocks before it (Difficulty::follow), and no account other
+//      than the issuers (SYSTEM rewards, FIAT on/off ramp) may ever go negative
+class ChainValidator
+{
+public:
+    // retarget parameters of the chain (UMA_TARGET_BLOCK_MS, UMA_RETARGET_WINDOW);
+    // threads 0 = UMA_VALIDATE_THREADS, default one per core
+    ChainValidator(long long targetBlockMs, size_t retargetWindow, unsigned threads = 0);
+
+    // wallets == nullptr skips signature checks
+    ValidationReport validate(const ChainSnapshot &chain, WalletManager *wallets,
+                              ValidationProgress *progress = nullptr);
+
+    static bool isIssuer(const std::string &account);
+
+private:
+    long long targetBlockMs;
+    size_t retargetWindow;
+    unsigned threads;
+};
+
+#endif
@@ -0,0 +1,392 @@
+#include "Codec.h"
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define UMA_CODEC_X86 1
+#include <immintrin.h>
+#endif
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+static const char B64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static Codec::Impl detectImpl()
+{
+#ifdef UMA_CODEC_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Codec::AVX2;
+    if (__builtin_cpu_supports("ssse3"))
+        return Codec::SSSE3;
+#endif
+    return Codec::SCALAR;
+}
+
+static const Codec::Impl SUPPORTED = detectImpl();
+static std::atomic<int> active{(int)SUPPORTED};
+
+Codec::Impl Codec::implementation()
+{
+    return (Impl)active.load(std::memory_order_relaxed);
+}
+
+const char *Codec::implementationName()
+{
+    switch (implementation())
+    {
+    case AVX2:
+        return "avx2";
+    case SSSE3:
+        return "ssse3";
+    default:
+        return "scalar";
+    }
+}
+
+void Codec::setImplementation(Impl impl)
+{
+    active.store(impl > SUPPORTED ? (int)SUPPORTED : (int)impl, std::memory_order_relaxed);
+}
+
+// =====================================================
+//  Vector kernels. Each returns how many input bytes it
+//  consumed; the caller finishes the rest with scalar code.
+// =====================================================
+#ifdef UMA_CODEC_X86
+
+// 16 bytes -> 32 hex chars per step: split nibbles, map them through a pshufb table, interleave
+__attribute__((target("ssse3"))) static size_t hexEncodeSsse3(const unsigned char *src, size_t len, char *dst)
+{
+    const __m128i lut = _mm_loadu_si128((const __m128i *)HEX_DIGITS);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// same idea, 32 bytes per step; unpack works per 128-bit lane so the halves are swapped back with permute2x128
+__attribute__((target("avx2"))) static size_t hexEncodeAvx2(const unsigned char *src, size_t len, char *dst)
+{
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)HEX_DIGITS));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+// 16 hex chars -> 16 nibble values; valid gets all-ones lanes for hex digits
+__attribute__((target("ssse3"))) static inline __m128i hexNibbles(__m128i c, __m128i &valid)
+{
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i lc = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lc, _mm_set1_epi8('f' + 1)));
+    valid = _mm_or_si128(digit, alpha);
+    return _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                        _mm_and_si128(alpha, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+}
+
+// 32 hex chars -> 16 bytes per step; (hi * 16 + lo) via maddubs, then pack words to bytes.
+// Returns (size_t)-1 on an invalid character.
+__attribute__((target("ssse3"))) static size_t hexDecodeSsse3(const char *src, size_t len, unsigned char *dst)
+{
+    const __m128i weights = _mm_set1_epi16(0x0110); // bytes {16, 1}
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m128i v0, v1;
+        __m128i n0 = hexNibbles(_mm_loadu_si128((const __m128i *)(src + i)), v0);
+        __m128i n1 = hexNibbles(_mm_loadu_si128((const __m128i *)(src + i + 16)), v1);
+        if (_mm_movemask_epi8(_mm_and_si128(v0, v1)) != 0xFFFF)
+            return (size_t)-1;
+
+        __m128i w0 = _mm_maddubs_epi16(n0, weights);
+        __m128i w1 = _mm_maddubs_epi16(n1, weights);
+        _mm_storeu_si128((__m128i *)(dst + i / 2), _mm_packus_epi16(w0, w1));
+    }
+    return i;
+}
+
+// 12 bytes -> 16 chars per step (reads 16). Split 3 bytes into four 6-bit indices with
+// mulhi/mullo, then turn indices into ASCII by adding a per-range offset picked with pshufb.
+__attribute__((target("ssse3"))) static size_t base64EncodeSsse3(const unsigned char *src, size_t len, char *dst)
+{
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    size_t i = 0, o = 0;
+    for (; i + 16 <= len; i += 12, o += 16)
+    {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + i)), shuffle);
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(t0, t1);
+
+        __m128i sel = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+        __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+        sel = _mm_or_si128(sel, _mm_and_si128(upper, _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i *)(dst + o), _mm_add_epi8(idx, _mm_shuffle_epi8(offsets, sel)));
+    }
+    return i;
+}
+
+// 16 chars -> 12 bytes per step (writes 16, caller leaves slack). Range compares map ASCII
+// back to 6-bit values; maddubs/madd merge them into 24-bit groups; pshufb drops the 4th byte.
+// Returns (size_t)-1 on a character outside the alphabet.
+__attribute__((target("ssse3"))) static size_t base64DecodeSsse3(const char *src, size_t len, unsigned char *dst)
+{
+    size_t i = 0, o = 0;
+    for (; i + 16 <= len; i += 16, o += 12)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+        __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            return (size_t)-1;
+
+        __m128i v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+        v = _mm_or_si128(v, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+        v = _mm_or_si128(v, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+        v = _mm_or_si128(v, _mm_and_si128(plus, _mm_set1_epi8(62)));
+        v = _mm_or_si128(v, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+        __m128i merged = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i *)(dst + o), merged);
+    }
+    return i;
+}
+
+// AVX2 variant of the decoder: 32 chars -> 24 bytes per step (writes 32)
+__attribute__((target("avx2"))) static size_t base64DecodeAvx2(const char *src, size_t len, unsigned char *dst)
+{
+    size_t i = 0, o = 0;
+    for (; i + 32 <= len; i += 32, o += 24)
+    {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+        __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        __m256i plus = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+'));
+        __m256i slash = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'));
+
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+        if ((uint32_t)_mm256_movemask_epi8(valid) != 0xFFFFFFFFu)
+            return (size_t)-1;
+
+        __m256i v = _mm256_and_si256(upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A')));
+        v = _mm256_or_si256(v, _mm256_and_si256(lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a' - 26))));
+        v = _mm256_or_si256(v, _mm256_and_si256(digit, _mm256_add_epi8(c, _mm256_set1_epi8(52 - '0'))));
+        v = _mm256_or_si256(v, _mm256_and_si256(plus, _mm256_set1_epi8(62)));
+        v = _mm256_or_si256(v, _mm256_and_si256(slash, _mm256_set1_epi8(63)));
+
+        __m256i merged = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // 12 useful bytes sit at the bottom of each lane; store them back to back
+        _mm_storeu_si128((__m128i *)(dst + o), _mm256_castsi256_si128(merged));
+        _mm_storeu_si128((__m128i *)(dst + o + 12), _mm256_extracti128_si256(merged, 1));
+    }
+    return i;
+}
+
+#endif // UMA_CODEC_X86
+
+// =====================================================
+//  Public entry points (vector prefix + scalar tail)
+// =====================================================
+
+std::string Codec::hexEncode(const unsigned char *data, size_t len)
+{
+    std::string out(len * 2, '\0');
+    char *dst = &out[0];
+    size_t i = 0;
+
+#ifdef UMA_CODEC_X86
+    Impl impl = implementation();
+    if (impl == AVX2)
+        i = hexEncodeAvx2(data, len, dst);
+    if (impl >= SSSE3)
+        i += hexEncodeSsse3(data + i, len - i, dst + 2 * i);
+#endif
+
+    for (; i < len; i++)
+    {
+        dst[2 * i] = HEX_DIGITS[data[i] >> 4];
+        dst[2 * i + 1] = HEX_DIGITS[data[i] & 0x0f];
+    }
+    return out;
+}
+
+std::string Codec::hexEncode(const std::string &bytes)
+{
+    return hexEncode((const unsigned char *)bytes.data(), bytes.size());
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+bool Codec::hexDecode(const std::string &hex, std::vector<unsigned char> &out)
+{
+    if (hex.size() % 2 != 0)
+        return false;
+
+    size_t len = hex.size();
+    out.resize(len / 2);
+    size_t i = 0;
+
+#ifdef UMA_CODEC_X86
+    if (implementation() >= SSSE3)
+    {
+        i = hexDecodeSsse3(hex.data(), len, out.data());
+        if (i == (size_t)-1)
+            return false;
+    }
+#endif
+
+    for (; i < len; i += 2)
+    {
+        int hi = hexValue(hex[i]);
+        int lo = hexValue(hex[i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        out[i / 2] = (unsigned char)(hi << 4 | lo);
+    }
+    return true;
+}
+
+std::string Codec::base64Encode(const unsigned char *data, size_t len)
+{
+    std::string out(((len + 2) / 3) * 4, '\0');
+    char *dst = &out[0];
+    size_t i = 0;
+
+#ifdef UMA_CODEC_X86
+    if (implementation() >= SSSE3)
+        i = base64EncodeSsse3(data, len, dst);
+#endif
+
+    size_t o = i / 3 * 4;
+    for (; i + 3 <= len; i += 3, o += 4)
+    {
+        uint32_t v = (uint32_t)data[i] << 16 | (uint32_t)data[i + 1] << 8 | data[i + 2];
+        dst[o] = B64_ALPHABET[v >> 18];
+        dst[o + 1] = B64_ALPHABET[(v >> 12) & 63];
+        dst[o + 2] = B64_ALPHABET[(v >> 6) & 63];
+        dst[o + 3] = B64_ALPHABET[v & 63];
+    }
+
+    if (i < len)
+    {
+        uint32_t v = (uint32_t)data[i] << 16 | (i + 1 < len ? (uint32_t)data[i + 1] << 8 : 0);
+        dst[o] = B64_ALPHABET[v >> 18];
+        dst[o + 1] = B64_ALPHABET[(v >> 12) & 63];
+        dst[o + 2] = i + 1 < len ? B64_ALPHABET[(v >> 6) & 63] : '=';
+        dst[o + 3] = '=';
+    }
+    return out;
+}
+
+static int base64Value(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
+    return -1;
+}
+
+// accepts input with or without '=' padding
+bool Codec::base64Decode(const std::string &b64, std::vector<unsigned char> &out)
+{
+    size_t len = b64.size();
+    for (int pad = 0; pad < 2 && len > 0 && b64[len - 1] == '='; pad++)
+        len--;
+    if (len % 4 == 1)
+        return false;
+
+    size_t decoded = len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0);
+    out.resize(decoded + 32); // vector kernels store a few bytes past their output
+    const char *src = b64.data();
+    size_t i = 0;
+
+#ifdef UMA_CODEC_X86
+    Impl impl = implementation();
+    if (impl == AVX2)
+    {
+        i = base64DecodeAvx2(src, len, out.data());
+        if (i == (size_t)-1)
+            return false;
+    }
+    if (impl >= SSSE3)
+    {
+        size_t n = base64DecodeSsse3(src + i, len - i, out.data() + i / 4 * 3);
+        if (n == (size_t)-1)
+            return false;
+        i += n;
+    }
+#endif
+
+    size_t o = i / 4 * 3;
+    for (; i + 4 <= len; i += 4, o += 3)
+    {
+        int a = base64Value(src[i]), b = base64Value(src[i + 1]), c = base64Value(src[i + 2]), d = base64Value(src[i + 3]);
+        if ((a | b | c | d) < 0)
+            return false;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+        out[o] = (unsigned char)(v >> 16);
+        out[o + 1] = (unsigned char)(v >> 8);
+        out[o + 2] = (unsigned char)v;
+    }
+
+    if (i < len)
+    {
+        int a = base64Value(src[i]), b = base64Value(src[i + 1]);
+        int c = i + 2 < len ? base64Value(src[i + 2]) : 0;
+        if ((a | b | c) < 0)
+            return false;
+        uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6;
+        out[o++] = (unsigned char)(v >> 16);
+        if (i + 2 < len)
+            out[o++] = (unsigned char)(v >> 8);
+    }
+
+    out.resize(decoded);
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <string>
+#include <vector>
+
+// Hex and base64 (standard alphabet, '=' padding) codecs.
+// x86 builds pick an SSSE3 or AVX2 kernel at startup from CPUID; everything else,
+// and the tails the vector loops leave over, goes through the scalar code.
+class Codec
+{
+public:
+    enum Impl
+    {
+        SCALAR,
+        SSSE3,
+        AVX2
+    };
+
+    static std::string hexEncode(const unsigned char *data, size_t len);
+    static std::string hexEncode(const std::string &bytes);
+    static bool hexDecode(const std::string &hex, std::vector<unsigned char> &out); // false on odd length / non-hex
+
+    static std::string base64Encode(const unsigned char *data, size_t len);
+    static std::string base64Encode(const std::vector<unsigned char> &bytes) { return base64Encode(bytes.data(), bytes.size()); }
+    static bool base64Decode(const std::string &b64, std::vector<unsigned char> &out); // false on invalid input
+
+    static Impl implementation();
+    static const char *implementationName();
+    static void setImplementation(Impl impl); // benchmarks/tests; clamped to what the CPU supports
+};
+
+#endif
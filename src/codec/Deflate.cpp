@@ -0,0 +1,100 @@
+#include "Deflate.h"
+#include <zlib.h>
+
+bool Deflate::segment(const char *data, size_t len, int level, DeflateSegment &out)
+{
+    z_stream strm{};
+    // negative window bits: raw deflate, the container is written by Writer
+    if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    out.data.resize(deflateBound(&strm, len) + 16); // + sync flush marker
+    strm.next_in = (Bytef *)data;
+    strm.avail_in = (uInt)len;
+    strm.next_out = (Bytef *)&out.data[0];
+    strm.avail_out = (uInt)out.data.size();
+
+    int rc = deflate(&strm, Z_SYNC_FLUSH);
+    bool ok = (rc == Z_OK || rc == Z_BUF_ERROR) && strm.avail_in == 0;
+    out.data.resize(out.data.size() - strm.avail_out);
+    deflateEnd(&strm);
+    if (!ok)
+        return false;
+
+    out.crc = crc32(0, (const Bytef *)data, (uInt)len);
+    out.adler = adler32(1, (const Bytef *)data, (uInt)len);
+    out.rawBytes = len;
+    return true;
+}
+
+void Deflate::Writer::start(std::string &out)
+{
+    started = true;
+    if (format == GZIP)
+    {
+        // magic, deflate, no flags, mtime 0, no extra flags, OS unix
+        static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+        out.append(header, sizeof(header));
+    }
+    else
+    {
+        out.append("\x78\x9c", 2); // 32K window, default level
+    }
+}
+
+void Deflate::Writer::append(const DeflateSegment &seg, std::string &out)
+{
+    if (!started)
+        start(out);
+
+    out.append(seg.data);
+    crc = crc32_combine(crc, seg.crc, (z_off_t)seg.rawBytes);
+    adler = adler32_combine(adler, seg.adler, (z_off_t)seg.rawBytes);
+    total += seg.rawBytes;
+}
+
+bool Deflate::Writer::compress(const char *data, size_t len, int level, std::string &out)
+{
+    if (len == 0)
+        return true;
+
+    DeflateSegment seg;
+    if (!segment(data, len, level, seg))
+        return false;
+    append(seg, out);
+    return true;
+}
+
+void Deflate::Writer::finish(std::string &out)
+{
+    if (!started)
+        start(out);
+
+    out.append("\x03\x00", 2); // empty final fixed-Huffman block
+
+    unsigned char trailer[8];
+    if (format == GZIP)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            trailer[i] = (unsigned char)(crc >> (8 * i));
+            trailer[4 + i] = (unsigned char)(total >> (8 * i)); // ISIZE, mod 2^32
+        }
+        out.append((const char *)trailer, 8);
+    }
+    else
+    {
+        for (int i = 0; i < 4; i++)
+            trailer[i] = (unsigned char)(adler >> (24 - 8 * i));
+        out.append((const char *)trailer, 4);
+    }
+}
+
+bool Deflate::compress(Format format, const std::string &in, int level, std::string &out)
+{
+    Writer writer(format);
+    if (!writer.compress(in.data(), in.size(), level, out))
+        return false;
+    writer.finish(out);
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <cstdint>
+#include <string>
+
+// A self-contained piece of a raw deflate stream: compressed from a fresh state (no
+// back-references outside itself) and ended with a sync flush, so pieces compressed at
+// different times can be spliced in any order and wrapped as one gzip or zlib stream.
+struct DeflateSegment
+{
+    std::string data;   // raw deflate, byte aligned, no final block
+    uint32_t crc = 0;   // crc32 of the uncompressed bytes (gzip trailer)
+    uint32_t adler = 1; // adler32 of the uncompressed bytes (zlib trailer)
+    size_t rawBytes = 0;
+};
+
+class Deflate
+{
+public:
+    enum Format
+    {
+        GZIP, // RFC 1952, HTTP "gzip"
+        ZLIB  // RFC 1950, HTTP "deflate"
+    };
+
+    // level 1 (fast) .. 9 (small)
+    static bool segment(const char *data, size_t len, int level, DeflateSegment &out);
+
+    // Builds one gzip/zlib stream from segments; output is appended to the caller's buffer
+    // so it can be handed out chunk by chunk. Checksums are combined, never recomputed.
+    class Writer
+    {
+    public:
+        explicit Writer(Format format) : format(format) {}
+
+        void append(const DeflateSegment &seg, std::string &out);
+        bool compress(const char *data, size_t len, int level, std::string &out); // segment + append
+        void finish(std::string &out); // final block and trailer
+
+    private:
+        void start(std::string &out);
+
+        Format format;
+        bool started = false;
+        uint32_t crc = 0;
+        uint32_t adler = 1;
+        uint64_t total = 0;
+    };
+
+    // whole body in one stream
+    static bool compress(Format format, const std::string &in, int level, std::string &out);
+};
+
+#endif
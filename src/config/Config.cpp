@@ -0,0 +1,42 @@
+#include "Config.h"
+#include <cstdlib>
+
+long long Config::getInt(const char *name, long long fallback)
+{
+    const char *raw = std::getenv(name);
+    if (!raw || !*raw)
+        return fallback;
+
+    try
+    {
+        return std::stoll(raw);
+    }
+    catch (...)
+    {
+        return fallback;
+    }
+}
+
+double Config::getDouble(const char *name, double fallback)
+{
+    const char *raw = std::getenv(name);
+    if (!raw || !*raw)
+        return fallback;
+
+    try
+    {
+        return std::stod(raw);
+    }
+    catch (...)
+    {
+        return fallback;
+    }
+}
+
+std::string Config::getString(const char *name, const std::string &fallback)
+{
+    const char *raw = std::getenv(name);
+    if (!raw || !*raw)
+        return fallback;
+    return raw;
+}
@@ -0,0 +1,16 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+
+// Startup configuration read from environment variables (same mechanism as PORT / CLIENT_URL).
+// Unset or unparsable variables fall back to the given default.
+class Config
+{
+public:
+    static long long getInt(const char *name, long long fallback);
+    static double getDouble(const char *name, double fallback);
+    static std::string getString(const char *name, const std::string &fallback);
+};
+
+#endif
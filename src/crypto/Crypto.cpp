@@ -1,14 +1,17 @@
-// debug version - paste into Crypto.cpp (temporary)
 #include "Crypto.h"
+#include "../log/Logger.h"
+#include "../codec/Codec.h"
+#include "Sha256.h"
 #include <openssl/evp.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
-#include <openssl/sha.h>
 #include <openssl/bio.h>
-#include <iomanip>
-#include <sstream>
-#include <iostream>
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
+#include <unordered_map>
 
 // Remove whitespace (including newline) from a string
 static std::string remove_whitespace(const std::string &s)
@@ -66,36 +69,6 @@ static std::string normalize_pubkey_pem(const std::string &rawPem)
     return header + "\n" + wrap_base64(b64) + footer + "\n";
 }
 
-// Base64 decode using OpenSSL BIO; returns vector of bytes
-static std::vector<unsigned char> base64_decode_vec(const std::string &in)
-{
-    BIO *bio = nullptr;
-    BIO *b64 = nullptr;
-    std::vector<unsigned char> out;
-
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new_mem_buf(in.data(), (int)in.size());
-    if (!bio || !b64)
-    {
-        if (bio)
-            BIO_free(bio);
-        if (b64)
-            BIO_free(b64);
-        return {};
-    }
-    bio = BIO_push(b64, bio);
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL);
-
-    // allocate output buffer (rough upper bound)
-    out.resize(in.size());
-    int decoded_len = BIO_read(bio, out.data(), (int)out.size());
-    BIO_free_all(bio);
-    if (decoded_len <= 0)
-        return {};
-    out.resize(decoded_len);
-    return out;
-}
-
 static void print_openssl_errors()
 {
     unsigned long e;
@@ -103,177 +76,317 @@ static void print_openssl_errors()
     {
         char buf[256];
         ERR_error_string_n(e, buf, sizeof(buf));
-        std::cerr << "OpenSSL error: " << buf << std::endl;
+        LOG_WARN("openssl error", {"detail", buf});
     }
 }
 
 static std::string bytes_to_hex_prefix(const unsigned char *data, size_t len, size_t prefix = 8)
 {
-    std::ostringstream ss;
-    ss << std::hex << std::setfill('0');
-    size_t n = std::min(prefix, len);
-    for (size_t i = 0; i < n; i++)
-        ss << std::setw(2) << (int)data[i];
-    return ss.str();
+    return Codec::hexEncode(data, std::min(prefix, len));
 }
 
-static std::string sha256_hex_str(const std::string &msg)
+std::string Crypto::sha256_hex(const std::string &data)
 {
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256((const unsigned char *)msg.data(), msg.size(), hash);
-    std::ostringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++)
-        ss << std::setw(2) << (int)hash[i];
-    return ss.str();
+    return Sha256::hex(data);
 }
 
-bool Crypto::verifySignaturePEM(const std::string &pubKeyPem, const std::string &message, const std::string &signatureBase64)
+std::shared_ptr<EVP_PKEY> Crypto::parsePublicKeyPEM(const std::string &pubKeyPem)
 {
-    std::cerr << "---- verifySignaturePEM debug start ----\n";
     std::string normalized = normalize_pubkey_pem(pubKeyPem);
-    std::cerr << "Normalized PEM (first 200 chars):\n"
-              << normalized.substr(0, std::min<size_t>(normalized.size(), 200)) << "\n";
-    std::vector<unsigned char> sig = base64_decode_vec(signatureBase64);
 
-    std::vector<unsigned char> derSig; // will hold final DER signature bytes
-
-    if (sig.size() == 64)
+    BIO *bio = BIO_new_mem_buf(normalized.data(), (int)normalized.size());
+    if (!bio)
     {
-        // Interpret as raw r||s (r: first 32, s: last 32)
-        const unsigned char *rbytes = sig.data();
-        const unsigned char *sbytes = sig.data() + 32;
-
-        // Convert to BIGNUMs
-        BIGNUM *r = BN_bin2bn(rbytes, 32, nullptr);
-        BIGNUM *s = BN_bin2bn(sbytes, 32, nullptr);
-        if (!r || !s)
-        {
-            if (r)
-                BN_free(r);
-            if (s)
-                BN_free(s);
-            std::cerr << "Crypto: BN_bin2bn failed for raw signature\n";
-            // cleanup and return false (or continue to try DER path if you want)
-            return false;
-        }
+        print_openssl_errors();
+        LOG_WARN("BIO_new_mem_buf failed");
+        return nullptr;
+    }
+    EVP_PKEY *pkey = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    if (!pkey)
+    {
+        LOG_WARN("PEM_read_bio_PUBKEY failed");
+        print_openssl_errors();
+        return nullptr;
+    }
 
-        // Create an ECDSA_SIG and set r and s
-        ECDSA_SIG *ecs = ECDSA_SIG_new();
-        if (!ecs)
-        {
-            BN_free(r);
-            BN_free(s);
-            std::cerr << "Crypto: ECDSA_SIG_new failed\n";
-            return false;
-        }
+    return std::shared_ptr<EVP_PKEY>(pkey, EVP_PKEY_free);
+}
 
-#if OPENSSL_VERSION_NUMBER >= 0x10100000L
-        // In modern OpenSSL use ECDSA_SIG_set0 which takes ownership of BNs
-        if (ECDSA_SIG_set0(ecs, r, s) != 1)
-        {
-            ECDSA_SIG_free(ecs);
-            BN_free(r);
-            BN_free(s); // if not consumed
-            std::cerr << "Crypto: ECDSA_SIG_set0 failed\n";
-            return false;
-        }
-#else
-        // Older OpenSSL: set r and s manually (be careful with ownership)
-        ecs->r = r;
-        ecs->s = s;
-#endif
-
-        // Convert ECDSA_SIG to DER bytes
-        int derLen = i2d_ECDSA_SIG(ecs, nullptr);
-        if (derLen <= 0)
-        {
-            ECDSA_SIG_free(ecs);
-            std::cerr << "Crypto: i2d_ECDSA_SIG failed (len)\n";
-            return false;
-        }
+std::string Crypto::publicKeyFingerprint(EVP_PKEY *pkey)
+{
+    if (!pkey)
+        return "";
 
-        derSig.resize(derLen);
-        unsigned char *p = derSig.data();
-        int derLen2 = i2d_ECDSA_SIG(ecs, &p);
-        ECDSA_SIG_free(ecs);
+    unsigned char *der = nullptr;
+    int len = i2d_PUBKEY(pkey, &der);
+    if (len <= 0)
+        return "";
 
-        if (derLen2 != derLen)
-        {
-            std::cerr << "Crypto: DER length mismatch\n";
-            return false;
-        }
+    unsigned char hash[Sha256::DIGEST_BYTES];
+    Sha256::digest(der, len, hash);
+    OPENSSL_free(der);
+    return std::string((const char *)hash, Sha256::DIGEST_BYTES);
+}
 
-        // Replace 'sig' with derSig for verification
-        sig = derSig;
-        std::cerr << "Crypto: converted raw 64-byte signature -> DER len=" << sig.size() << "\n";
-    }
+// OpenSSL group names for each KeyType, indexed by the tag
+static const char *KEY_GROUPS[] = {nullptr, "prime256v1", "secp256k1"};
+static const char *KEY_NAMES[] = {nullptr, "p256", "secp256k1"};
+static const size_t KEY_TYPE_COUNT = sizeof(KEY_GROUPS) / sizeof(KEY_GROUPS[0]);
 
-    std::cerr << "signatureBase64 length: " << signatureBase64.size() << " -> decoded bytes: " << sig.size() << "\n";
-    if (!sig.empty())
-        std::cerr << "sig hex prefix: " << bytes_to_hex_prefix(sig.data(), sig.size()) << "\n";
-    std::cerr << "Message length: " << message.size() << " message: [" << message << "]\n";
-    std::cerr << "Message SHA256: " << sha256_hex_str(message) << "\n";
+const char *Crypto::keyTypeName(uint8_t type)
+{
+    return type < KEY_TYPE_COUNT && KEY_NAMES[type] ? KEY_NAMES[type] : "";
+}
 
-    BIO *bio = BIO_new_mem_buf(normalized.data(), (int)normalized.size());
-    if (!bio)
+uint8_t Crypto::keyTypeFromName(const std::string &name)
+{
+    for (size_t t = 1; t < KEY_TYPE_COUNT; t++)
+        if (name == KEY_NAMES[t])
+            return (uint8_t)t;
+    return KEY_NONE;
+}
+
+bool Crypto::compactPublicKey(EVP_PKEY *pkey, CompactPublicKey &out)
+{
+    if (!pkey || EVP_PKEY_get_base_id(pkey) != EVP_PKEY_EC)
+        return false;
+
+    char group[64];
+    size_t groupLen = 0;
+    if (EVP_PKEY_get_utf8_string_param(pkey, OSSL_PKEY_PARAM_GROUP_NAME, group, sizeof(group), &groupLen) != 1)
+        return false;
+
+    uint8_t type = KEY_NONE;
+    for (size_t t = 1; t < KEY_TYPE_COUNT; t++)
+        if (!strcmp(group, KEY_GROUPS[t]))
+            type = (uint8_t)t;
+    if (type == KEY_NONE)
     {
-        print_openssl_errors();
-        std::cerr << "BIO_new_mem_buf fail\n";
+        LOG_WARN("unsupported public key curve", {"group", group});
         return false;
     }
-    EVP_PKEY *pkey = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
-    if (!pkey)
+
+    unsigned char encoded[65];
+    size_t len = 0;
+    if (EVP_PKEY_get_octet_string_param(pkey, OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, encoded, sizeof(encoded), &len) != 1)
+        return false;
+
+    if (len == 65 && encoded[0] == 0x04)
     {
-        std::cerr << "PEM_read_bio_PUBKEY failed\n";
+        // uncompressed 04||x||y -> (02|03)||x, the prefix carrying y's parity
+        out.point[0] = 0x02 | (encoded[64] & 1);
+        memcpy(out.point.data() + 1, encoded + 1, 32);
+    }
+    else if (len == 33 && (encoded[0] == 0x02 || encoded[0] == 0x03))
+        memcpy(out.point.data(), encoded, 33);
+    else
+        return false;
+
+    out.type = type;
+    return true;
+}
+
+std::shared_ptr<EVP_PKEY> Crypto::publicKeyFromCompact(const CompactPublicKey &key)
+{
+    if (key.type == KEY_NONE || key.type >= KEY_TYPE_COUNT)
+        return nullptr;
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, (char *)KEY_GROUPS[key.type], 0),
+        OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_PUB_KEY, (void *)key.point.data(), key.point.size()),
+        OSSL_PARAM_construct_end()};
+
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_from_name(nullptr, "EC", nullptr);
+    EVP_PKEY *pkey = nullptr;
+    // fromdata decompresses the point, which fails for an x that isn't on the curve
+    if (!ctx || EVP_PKEY_fromdata_init(ctx) != 1 || EVP_PKEY_fromdata(ctx, &pkey, EVP_PKEY_PUBLIC_KEY, params) != 1)
+    {
+        LOG_WARN("EVP_PKEY_fromdata failed for compact key", {"type", keyTypeName(key.type)});
         print_openssl_errors();
-        BIO_free(bio);
+        EVP_PKEY_CTX_free(ctx);
+        return nullptr;
+    }
+    EVP_PKEY_CTX_free(ctx);
+
+    // keep the SPKI encoding uncompressed so PEM/fingerprints match what clients generate
+    EVP_PKEY_set_utf8_string_param(pkey, OSSL_PKEY_PARAM_EC_POINT_CONVERSION_FORMAT, "uncompressed");
+    return std::shared_ptr<EVP_PKEY>(pkey, EVP_PKEY_free);
+}
+
+std::string Crypto::compactKeyToString(const CompactPublicKey &key)
+{
+    return std::string(keyTypeName(key.type)) + ":" + Codec::base64Encode(key.point.data(), key.point.size());
+}
+
+bool Crypto::compactKeyFromString(const std::string &s, CompactPublicKey &out)
+{
+    size_t colon = s.find(':');
+    if (colon == std::string::npos)
+        return false;
+
+    std::vector<unsigned char> point;
+    out.type = keyTypeFromName(s.substr(0, colon));
+    if (out.type == KEY_NONE || !Codec::base64Decode(s.substr(colon + 1), point) || point.size() != out.point.size())
+        return false;
+    std::copy(point.begin(), point.end(), out.point.begin());
+    return true;
+}
+
+std::string Crypto::publicKeyToPEM(EVP_PKEY *pkey)
+{
+    if (!pkey)
+        return "";
+
+    unsigned char *der = nullptr;
+    int len = i2d_PUBKEY(pkey, &der);
+    if (len <= 0)
+        return "";
+
+    std::string b64 = Codec::base64Encode(der, len);
+    OPENSSL_free(der);
+    return "-----BEGIN PUBLIC KEY-----\n" + wrap_base64(b64) + "-----END PUBLIC KEY-----\n";
+}
+
+bool Crypto::verifySignaturePEM(const std::string &pubKeyPem, const std::string &message, const std::string &signatureBase64)
+{
+    std::shared_ptr<EVP_PKEY> pkey = parsePublicKeyPEM(pubKeyPem);
+    if (!pkey)
         return false;
+
+    return verifySignature(pkey.get(), message, signatureBase64);
+}
+
+// ----------------------------------------------------------------
+//  Per-thread verification state, reused across calls: a verify
+//  EVP_PKEY_CTX per key (set up once, not per signature) and the
+//  scratch buffer signatures are decoded into
+// ----------------------------------------------------------------
+namespace
+{
+    struct ThreadVerifier
+    {
+        static const size_t MAX_KEYS = 256; // per thread; cleared wholesale when full
+
+        // each ctx holds a reference on its key, so a pointer can't be reused for another key while cached
+        std::unordered_map<EVP_PKEY *, EVP_PKEY_CTX *> contexts;
+        std::vector<unsigned char> sig; // keeps its capacity between calls
+
+        ~ThreadVerifier() { clear(); }
+
+        void clear()
+        {
+            for (auto &kv : contexts)
+                EVP_PKEY_CTX_free(kv.second);
+            contexts.clear();
+        }
+
+        EVP_PKEY_CTX *contextFor(EVP_PKEY *pkey)
+        {
+            auto it = contexts.find(pkey);
+            if (it != contexts.end())
+                return it->second;
+
+            if (contexts.size() >= MAX_KEYS)
+                clear();
+
+            EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(pkey, nullptr);
+            if (!ctx || EVP_PKEY_verify_init(ctx) != 1 || EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()) != 1)
+            {
+                LOG_WARN("verify context setup failed");
+                print_openssl_errors();
+                EVP_PKEY_CTX_free(ctx);
+                return nullptr;
+            }
+            contexts[pkey] = ctx;
+            return ctx;
+        }
+    };
+
+    ThreadVerifier &threadVerifier()
+    {
+        thread_local ThreadVerifier tv;
+        return tv;
     }
-    std::cerr << "PKEY loaded ok\n";
 
-    EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
-    int v = -1;
-    if (!mdctx)
+    // DER INTEGER for an unsigned big-endian value: minimal length, 0x00 prefix if the top bit is set
+    size_t derInteger(const unsigned char *v, size_t n, unsigned char *out)
     {
-        std::cerr << "EVP_MD_CTX_new fail\n";
-        EVP_PKEY_free(pkey);
-        BIO_free(bio);
-        return false;
+        while (n > 1 && v[0] == 0)
+        {
+            v++;
+            n--;
+        }
+        size_t pad = (v[0] & 0x80) ? 1 : 0;
+        out[0] = 0x02;
+        out[1] = (unsigned char)(n + pad);
+        if (pad)
+            out[2] = 0x00;
+        memcpy(out + 2 + pad, v, n);
+        return 2 + pad + n;
     }
 
-    if (EVP_DigestVerifyInit(mdctx, nullptr, EVP_sha256(), nullptr, pkey) != 1)
+    // raw r||s (2 x 32 bytes, WebCrypto) -> DER ECDSA-Sig-Value; at most 72 bytes, so short-form lengths
+    size_t rawSignatureToDer(const unsigned char *rs, unsigned char *der)
     {
-        std::cerr << "EVP_DigestVerifyInit failed\n";
-        print_openssl_errors();
-        goto cleanup;
+        size_t len = derInteger(rs, 32, der + 2);
+        len += derInteger(rs + 32, 32, der + 2 + len);
+        der[0] = 0x30;
+        der[1] = (unsigned char)len;
+        return len + 2;
     }
-    if (EVP_DigestVerifyUpdate(mdctx, message.data(), message.size()) != 1)
+}
+
+bool Crypto::verifySignature(EVP_PKEY *pkey, const std::string &message, const std::string &signatureBase64)
+{
+    if (!pkey)
+        return false;
+
+    ThreadVerifier &tv = threadVerifier();
+    if (!Codec::base64Decode(signatureBase64, tv.sig) || tv.sig.empty())
     {
-        std::cerr << "EVP_DigestVerifyUpdate failed\n";
-        print_openssl_errors();
-        goto cleanup;
+        LOG_DEBUG("signature is not valid base64", {"sigB64Len", signatureBase64.size()});
+        return false;
     }
 
-    v = EVP_DigestVerifyFinal(mdctx, sig.data(), sig.size());
-    if (v == 1)
+    const unsigned char *sig = tv.sig.data();
+    size_t sigLen = tv.sig.size();
+    unsigned char der[72];
+
+    if (sigLen == 64)
     {
-        std::cerr << "Signature VERIFIED OK\n";
+        // Interpret as raw r||s (r: first 32, s: last 32), re-encode as DER in place of BIGNUM/ECDSA_SIG
+        sigLen = rawSignatureToDer(sig, der);
+        sig = der;
+        LOG_TRACE("converted raw r||s signature to DER", {"derLen", sigLen});
     }
-    else if (v == 0)
+
+    // arguments below are only evaluated when trace logging is on
+    LOG_TRACE("verify signature",
+              {"sigB64Len", signatureBase64.size()},
+              {"sigLen", sigLen},
+              {"sigPrefix", bytes_to_hex_prefix(sig, sigLen)},
+              {"message", message},
+              {"messageSha256", Sha256::hex(message)});
+
+    EVP_PKEY_CTX *ctx = tv.contextFor(pkey);
+    if (!ctx)
+        return false;
+
+    // hash on the thread's digest context, then verify the digest with the cached key context
+    unsigned char digest[Sha256::DIGEST_BYTES];
+    Sha256::digest(message.data(), message.size(), digest);
+
+    int v = EVP_PKEY_verify(ctx, sig, sigLen, digest, sizeof(digest));
+    if (v == 0)
     {
-        std::cerr << "Signature verification FAILED (v==0)\n";
+        LOG_DEBUG("signature verification failed", {"messageLen", message.size()});
     }
-    else
+    else if (v != 1)
     {
-        std::cerr << "EVP_DigestVerifyFinal returned error\n";
+        LOG_WARN("EVP_PKEY_verify returned error", {"rc", v});
         print_openssl_errors();
     }
 
-cleanup:
-    EVP_MD_CTX_free(mdctx);
-    EVP_PKEY_free(pkey);
-    BIO_free(bio);
-    std::cerr << "---- verifySignaturePEM debug end ----\n";
     return v == 1;
 }
@@ -2,9 +2,57 @@
 #define CRYPTO_H
 
 #include <string>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include <openssl/evp.h>
+
+// EC public key as a curve tag plus the SEC1 compressed point (33 bytes), stored inline.
+// This is what WalletManager keeps and persists; PEM only exists at the API edge.
+struct CompactPublicKey
+{
+    uint8_t type = 0; // Crypto::KeyType, KEY_NONE = no key
+    std::array<unsigned char, 33> point{};
+
+    bool empty() const { return type == 0; }
+};
 
 class Crypto {
 public:
+    enum KeyType : uint8_t
+    {
+        KEY_NONE = 0,
+        KEY_P256 = 1,      // prime256v1 / secp256r1 (WebCrypto ECDSA)
+        KEY_SECP256K1 = 2,
+    };
+
+    // short names used in persisted files ("p256", "secp256k1"); KEY_NONE for unknown names
+    static const char *keyTypeName(uint8_t type);
+    static uint8_t keyTypeFromName(const std::string &name);
+
+    // EVP_PKEY <-> compact form. compactPublicKey fails for keys on curves we don't tag.
+    static bool compactPublicKey(EVP_PKEY *pkey, CompactPublicKey &out);
+    static std::shared_ptr<EVP_PKEY> publicKeyFromCompact(const CompactPublicKey &key);
+
+    // "<type name>:<base64 point>", the persisted form (wallets.json pubkeys, tx signerKey)
+    static std::string compactKeyToString(const CompactPublicKey &key);
+    static bool compactKeyFromString(const std::string &s, CompactPublicKey &out);
+
+    // SubjectPublicKeyInfo PEM (uncompressed point, 64-char lines), for API responses
+    static std::string publicKeyToPEM(EVP_PKEY *pkey);
+
+    // Parse a public key once so it can be reused for many verifications (see KeyCache).
+    // Accepts PEM with or without line breaks, or the bare base64 body. nullptr if invalid.
+    static std::shared_ptr<EVP_PKEY> parsePublicKeyPEM(const std::string &pubKeyPem);
+
+    // SHA-256 of the DER SubjectPublicKeyInfo (raw 32 bytes): stable id of a key, independent of PEM formatting
+    static std::string publicKeyFingerprint(EVP_PKEY *pkey);
+
+    // Verify against an already parsed key; no PEM handling on this path.
+    static bool verifySignature(EVP_PKEY *pkey,
+                                const std::string &message,
+                                const std::string &signatureBase64);
+
     // Verify signature: pubKeyPem = "-----BEGIN PUBLIC KEY-----..."; 
     // message is the original string signed; signatureBase64 is base64-encoded DER signature (WebCrypto output).
     static bool verifySignaturePEM(const std::string &pubKeyPem,
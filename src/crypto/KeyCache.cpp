@@ -0,0 +1,33 @@
+#include "KeyCache.h"
+#include "Crypto.h"
+#include <mutex>
+
+std::shared_ptr<EVP_PKEY> KeyCache::get(const std::string &walletId, std::string *fingerprint) const
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = keys.find(walletId);
+    if (it == keys.end())
+        return nullptr;
+    if (fingerprint)
+        *fingerprint = it->second.fingerprint;
+    return it->second.key;
+}
+
+void KeyCache::put(const std::string &walletId, std::shared_ptr<EVP_PKEY> key)
+{
+    std::string fingerprint = Crypto::publicKeyFingerprint(key.get());
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    keys[walletId] = Entry{std::move(key), std::move(fingerprint)};
+}
+
+void KeyCache::invalidate(const std::string &walletId)
+{
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    keys.erase(walletId);
+}
+
+size_t KeyCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return keys.size();
+}
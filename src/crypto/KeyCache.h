@@ -0,0 +1,33 @@
+#ifndef KEY_CACHE_H
+#define KEY_CACHE_H
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <openssl/evp.h>
+
+// Parsed EVP_PKEY handles (plus their fingerprint) keyed by wallet id, so signature checks never touch PEM.
+// Readers take a shared lock and get a ref-counted handle that stays valid even if the
+// wallet is rebound while they verify. OpenSSL keys are safe to share for verification.
+class KeyCache
+{
+public:
+    // fingerprint (optional out) is Crypto::publicKeyFingerprint of the key, computed once at put()
+    std::shared_ptr<EVP_PKEY> get(const std::string &walletId, std::string *fingerprint = nullptr) const;
+    void put(const std::string &walletId, std::shared_ptr<EVP_PKEY> key);
+    void invalidate(const std::string &walletId);
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex mtx;
+    struct Entry
+    {
+        std::shared_ptr<EVP_PKEY> key;
+        std::string fingerprint;
+    };
+
+    std::unordered_map<std::string, Entry> keys;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "Sha256.h"
+#include "../codec/Codec.h"
+
+namespace
+{
+    struct ThreadDigest
+    {
+        EVP_MD_CTX *initialized = nullptr; // DigestInit done once, never updated
+        EVP_MD_CTX *work = nullptr;
+
+        ThreadDigest()
+        {
+            // fetched once per process instead of implicitly on every EVP_sha256() init
+            static EVP_MD *md = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+            initialized = EVP_MD_CTX_new();
+            work = EVP_MD_CTX_new();
+            EVP_DigestInit_ex2(initialized, md, nullptr);
+        }
+
+        ~ThreadDigest()
+        {
+            EVP_MD_CTX_free(initialized);
+            EVP_MD_CTX_free(work);
+        }
+    };
+}
+
+Sha256::Sha256()
+{
+    thread_local ThreadDigest td;
+    EVP_MD_CTX_copy_ex(td.work, td.initialized);
+    ctx = td.work;
+}
+
+Sha256 &Sha256::update(const void *data, size_t len)
+{
+    EVP_DigestUpdate(ctx, data, len);
+    return *this;
+}
+
+void Sha256::final(unsigned char *out)
+{
+    unsigned int len = 0;
+    EVP_DigestFinal_ex(ctx, out, &len);
+}
+
+void Sha256::digest(const void *data, size_t len, unsigned char *out)
+{
+    Sha256().update(data, len).final(out);
+}
+
+std::string Sha256::hex(const std::string &data)
+{
+    unsigned char d[DIGEST_BYTES];
+    digest(data.data(), data.size(), d);
+    return Codec::hexEncode(d, DIGEST_BYTES);
+}
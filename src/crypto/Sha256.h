@@ -0,0 +1,28 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <string>
+#include <openssl/evp.h>
+
+// SHA-256 on a per-thread EVP_MD_CTX that is copied from an already initialized template
+// (EVP_MD_CTX_copy_ex), so a hash costs no digest fetch and no context setup.
+// Only one Sha256 may be in use per thread at a time (they share the thread's context).
+class Sha256
+{
+public:
+    static const size_t DIGEST_BYTES = 32;
+
+    Sha256(); // starts a fresh digest
+    Sha256 &update(const void *data, size_t len);
+    Sha256 &update(const std::string &s) { return update(s.data(), s.size()); }
+    void final(unsigned char *out); // DIGEST_BYTES
+
+    static void digest(const void *data, size_t len, unsigned char *out);
+    static std::string hex(const std::string &data); // lowercase hex of the digest
+
+private:
+    EVP_MD_CTX *ctx; // the thread's work context
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "SigCache.h"
+#include "../config/Config.h"
+#include "Sha256.h"
+
+SigCache::SigCache(size_t capacity)
+{
+    perShard = capacity / SHARDS;
+    if (perShard == 0)
+        perShard = 1;
+}
+
+SigCache &SigCache::instance()
+{
+    static SigCache cache((size_t)Config::getInt("UMA_SIGCACHE_ENTRIES", 100000));
+    return cache;
+}
+
+// length-prefixed so different (message, signature) splits can't collide
+SigCache::Digest SigCache::digestFor(const std::string &keyId, const std::string &message, const std::string &signatureBase64)
+{
+    Sha256 sha;
+    for (const std::string *part : {&keyId, &message, &signatureBase64})
+    {
+        uint32_t len = (uint32_t)part->size();
+        sha.update(&len, sizeof(len)).update(*part);
+    }
+
+    Digest d;
+    sha.final(d.data());
+    return d;
+}
+
+bool SigCache::contains(const Digest &d) const
+{
+    const Shard &s = shardFor(d);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    bool found = s.entries.count(d) > 0;
+    if (found)
+        s.hits++;
+    else
+        s.misses++;
+    return found;
+}
+
+void SigCache::insert(const Digest &d)
+{
+    Shard &s = shardFor(d);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    if (!s.entries.insert(d).second)
+        return;
+
+    s.order.push_back(d);
+    while (s.order.size() > perShard)
+    {
+        s.entries.erase(s.order.front());
+        s.order.pop_front();
+    }
+}
+
+size_t SigCache::size() const
+{
+    size_t total = 0;
+    for (const auto &s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        total += s.entries.size();
+    }
+    return total;
+}
+
+unsigned long long SigCache::hits() const
+{
+    unsigned long long total = 0;
+    for (const auto &s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        total += s.hits;
+    }
+    return total;
+}
+
+unsigned long long SigCache::misses() const
+{
+    unsigned long long total = 0;
+    for (const auto &s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s.mtx);
+        total += s.misses;
+    }
+    return total;
+}
@@ -0,0 +1,63 @@
+#ifndef SIG_CACHE_H
+#define SIG_CACHE_H
+
+#include <array>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+// Remembers signatures that already verified, keyed by SHA-256(keyId, message, signature),
+// so re-validating blocks/chain doesn't redo EC math for transactions checked at admission.
+// Only successes are stored. Split into shards with their own lock; each shard is bounded
+// and forgets its oldest entries first.
+class SigCache
+{
+public:
+    using Digest = std::array<unsigned char, 32>;
+
+    explicit SigCache(size_t capacity);
+
+    static Digest digestFor(const std::string &keyId, const std::string &message, const std::string &signatureBase64);
+
+    bool contains(const Digest &d) const;
+    void insert(const Digest &d);
+
+    size_t size() const;
+    unsigned long long hits() const;
+    unsigned long long misses() const;
+
+    // process-wide cache, UMA_SIGCACHE_ENTRIES entries (default 100000)
+    static SigCache &instance();
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct DigestHash
+    {
+        size_t operator()(const Digest &d) const
+        {
+            size_t h;
+            std::memcpy(&h, d.data() + 8, sizeof(h)); // already uniformly distributed
+            return h;
+        }
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mtx;
+        std::unordered_set<Digest, DigestHash> entries;
+        std::deque<Digest> order; // insertion order, for eviction
+        mutable unsigned long long hits = 0;
+        mutable unsigned long long misses = 0;
+    };
+
+    Shard &shardFor(const Digest &d) { return shards[d[0] % SHARDS]; }
+    const Shard &shardFor(const Digest &d) const { return shards[d[0] % SHARDS]; }
+
+    Shard shards[SHARDS];
+    size_t perShard;
+};
+
+#endif
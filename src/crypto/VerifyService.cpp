@@ -0,0 +1,142 @@
+#include "VerifyService.h"
+#include "Crypto.h"
+#include "SigCache.h"
+#include "../config/Config.h"
+#include "../metrics/Metrics.h"
+#include <chrono>
+
+VerifyService::VerifyService(size_t threads)
+{
+    if (threads == 0)
+        threads = 1;
+    for (size_t i = 0; i < threads; i++)
+        workers.emplace_back([this]()
+                             { workerLoop(); });
+}
+
+VerifyService::~VerifyService()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &w : workers)
+        w.join();
+}
+
+VerifyService &VerifyService::instance()
+{
+    static VerifyService service((size_t)Config::getInt("UMA_VERIFY_THREADS", std::thread::hardware_concurrency()));
+    return service;
+}
+
+void VerifyService::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]()
+                    { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+std::future<bool> VerifyService::submit(VerifyJob job)
+{
+    std::vector<VerifyJob> one;
+    one.push_back(std::move(job));
+    return std::move(submitBatch(std::move(one)).front());
+}
+
+// ---------------------------------------------------
+//  Split the batch into one chunk per worker; each
+//  chunk fulfils the promises of its own jobs
+// ---------------------------------------------------
+std::vector<std::future<bool>> VerifyService::submitBatch(std::vector<VerifyJob> jobs)
+{
+    std::vector<std::future<bool>> futures;
+    if (jobs.empty())
+        return futures;
+
+    struct Chunk
+    {
+        std::vector<VerifyJob> jobs;
+        std::vector<std::promise<bool>> results;
+    };
+
+    size_t chunks = std::min(jobs.size(), workers.size());
+    size_t per = (jobs.size() + chunks - 1) / chunks;
+    futures.reserve(jobs.size());
+
+    std::vector<std::function<void()>> queued;
+    for (size_t start = 0; start < jobs.size(); start += per)
+    {
+        auto chunk = std::make_shared<Chunk>();
+        size_t end = std::min(jobs.size(), start + per);
+        for (size_t i = start; i < end; i++)
+        {
+            chunk->jobs.push_back(std::move(jobs[i]));
+            chunk->results.emplace_back();
+            futures.push_back(chunk->results.back().get_future());
+        }
+
+        queued.push_back([chunk]()
+                         {
+            for (size_t i = 0; i < chunk->jobs.size(); i++)
+                chunk->results[i].set_value(verifyNow(chunk->jobs[i])); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &task : queued)
+            tasks.push_back(std::move(task));
+    }
+    cv.notify_all();
+
+    return futures;
+}
+
+bool VerifyService::verifyNow(const VerifyJob &job)
+{
+    if (!job.key)
+        return false;
+
+    static const Metrics::Id cached = Metrics::counter("uma_verify_total", "Signature checks", "result=\"cached\"");
+    static const Metrics::Id valid = Metrics::counter("uma_verify_total", "Signature checks", "result=\"valid\"");
+    static const Metrics::Id invalid = Metrics::counter("uma_verify_total", "Signature checks", "result=\"invalid\"");
+    static const Metrics::Id verifyTime = Metrics::histogram("uma_verify_duration_seconds", "ECDSA verification, cache misses only");
+
+    std::string keyId = job.keyId.empty() ? Crypto::publicKeyFingerprint(job.key.get()) : job.keyId;
+    SigCache::Digest digest = SigCache::digestFor(keyId, job.message, job.signatureBase64);
+    if (SigCache::instance().contains(digest))
+    {
+        Metrics::add(cached);
+        return true;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    bool ok = Crypto::verifySignature(job.key.get(), job.message, job.signatureBase64);
+    Metrics::record(verifyTime, std::chrono::steady_clock::now() - started);
+    Metrics::add(ok ? valid : invalid);
+    if (ok)
+        SigCache::instance().insert(digest);
+    return ok;
+}
+
+std::vector<bool> VerifyService::verifyAll(std::vector<VerifyJob> jobs)
+{
+    std::vector<std::future<bool>> futures = submitBatch(std::move(jobs));
+    std::vector<bool> results;
+    results.reserve(futures.size());
+    for (auto &f : futures)
+        results.push_back(f.get());
+    return results;
+}
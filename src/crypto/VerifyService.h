@@ -0,0 +1,61 @@
+#ifndef VERIFY_SERVICE_H
+#define VERIFY_SERVICE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/evp.h>
+
+// One signature check: parsed key (see KeyCache), the exact signed message and the base64 signature.
+// keyId is the key's fingerprint (Crypto::publicKeyFingerprint); computed on the worker if left empty.
+struct VerifyJob
+{
+    std::shared_ptr<EVP_PKEY> key;
+    std::string message;
+    std::string signatureBase64;
+    std::string keyId;
+};
+
+// Worker pool for ECDSA verification. Batches are split into chunks (one per worker) so a
+// large batch costs a handful of queue operations, and every job gets its own future.
+// Every job checks SigCache first; successful verifications are added to it.
+class VerifyService
+{
+public:
+    explicit VerifyService(size_t threads);
+    ~VerifyService();
+
+    VerifyService(const VerifyService &) = delete;
+    VerifyService &operator=(const VerifyService &) = delete;
+
+    std::future<bool> submit(VerifyJob job);
+    std::vector<std::future<bool>> submitBatch(std::vector<VerifyJob> jobs);
+
+    // submit and wait; results[i] belongs to jobs[i]
+    std::vector<bool> verifyAll(std::vector<VerifyJob> jobs);
+
+    size_t threadCount() const { return workers.size(); }
+
+    // process-wide pool, UMA_VERIFY_THREADS workers (default: one per core)
+    static VerifyService &instance();
+
+    // run one job on the calling thread (same SigCache handling), for callers that already fan out
+    static bool verifyNow(const VerifyJob &job);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,265 @@
+#include "EventHub.h"
+#include "../config/Config.h"
+#include "../log/Logger.h"
+
+// -----------------------------
+//  Subscriber
+// -----------------------------
+
+void EventHub::Subscriber::offer(const std::shared_ptr<const std::string> &frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (dropped || closed)
+            return;
+        if (queue.size() >= capacity)
+        {
+            // too slow: free what it holds and cut it off rather than buffer for it
+            dropped = true;
+            queue.clear();
+        }
+        else
+        {
+            queue.push_back(frame);
+        }
+    }
+    cv.notify_one();
+}
+
+void EventHub::Subscriber::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+    }
+    cv.notify_one();
+}
+
+EventHub::Subscriber::Wait EventHub::Subscriber::next(std::string &out, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait_for(lock, timeout, [&] { return !queue.empty() || dropped || closed; });
+
+    if (dropped)
+        return DROPPED;
+    if (closed)
+        return CLOSED;
+    if (queue.empty())
+        return TIMEOUT;
+
+    // everything queued goes out in one write
+    while (!queue.empty())
+    {
+        out.append(*queue.front());
+        queue.pop_front();
+    }
+    return EVENTS;
+}
+
+// -----------------------------
+//  Hub
+// -----------------------------
+
+EventHub::EventHub(size_t queueCapacity, size_t replay)
+    : queueCapacity(queueCapacity ? queueCapacity : (size_t)Config::getInt("UMA_SSE_QUEUE", 4096)),
+      replayCapacity(replay ? replay : (size_t)Config::getInt("UMA_SSE_REPLAY", 1024))
+{
+    dispatcher = std::thread(&EventHub::dispatchLoop, this);
+}
+
+EventHub::~EventHub()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingCv.notify_one();
+    dispatcher.join();
+
+    std::lock_guard<std::mutex> lock(subsMutex);
+    for (const auto &sub : everything)
+        sub->close();
+    for (const auto &kv : byWallet)
+        for (const auto &sub : kv.second)
+            sub->close();
+}
+
+EventHub::Prepared EventHub::prepare(const std::string &type, const nlohmann::json &data, std::vector<std::string> wallets)
+{
+    return {type, data.dump(), std::move(wallets)}; // single line, so one data: field
+}
+
+void EventHub::publish(const std::string &type, const nlohmann::json &data, std::vector<std::string> wallets)
+{
+    std::vector<Prepared> events;
+    events.push_back(prepare(type, data, std::move(wallets)));
+    publish(std::move(events));
+}
+
+void EventHub::publish(std::vector<Prepared> events)
+{
+    if (events.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (stopping)
+            return;
+        for (auto &p : events)
+        {
+            Event ev;
+            ev.id = ++nextId;
+            ev.frame = std::make_shared<const std::string>(
+                "id: " + std::to_string(ev.id) + "\nevent: " + p.type + "\ndata: " + p.body + "\n\n");
+            ev.wallets = std::move(p.wallets);
+            pending.push_back(std::move(ev));
+        }
+    }
+    pendingCv.notify_one();
+    published += events.size();
+}
+
+bool EventHub::wants(const Subscriber &sub, const Event &ev)
+{
+    if (sub.walletFilter.empty() || ev.wallets.empty())
+        return true;
+    for (const auto &w : ev.wallets)
+        if (w == sub.walletFilter)
+            return true;
+    return false;
+}
+
+void EventHub::deliver(const Event &ev)
+{
+    size_t n = 0;
+    auto offer = [&](const std::shared_ptr<Subscriber> &sub)
+    {
+        sub->offer(ev.frame);
+        n++;
+    };
+
+    for (const auto &sub : everything)
+        offer(sub);
+
+    if (ev.wallets.empty())
+    {
+        for (const auto &kv : byWallet)
+            for (const auto &sub : kv.second)
+                offer(sub);
+    }
+    else
+    {
+        for (size_t i = 0; i < ev.wallets.size(); i++)
+        {
+            // sender == receiver (or repeats) must not deliver twice
+            bool seen = false;
+            for (size_t j = 0; j < i && !seen; j++)
+                seen = ev.wallets[j] == ev.wallets[i];
+            auto it = seen ? byWallet.end() : byWallet.find(ev.wallets[i]);
+            if (it == byWallet.end())
+                continue;
+            for (const auto &sub : it->second)
+                offer(sub);
+        }
+    }
+
+    delivered += n;
+}
+
+void EventHub::dispatchLoop()
+{
+    std::deque<Event> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex);
+            pendingCv.wait(lock, [&] { return stopping || !pending.empty(); });
+            if (stopping)
+                return;
+            batch.swap(pending);
+        }
+
+        std::lock_guard<std::mutex> lock(subsMutex);
+        for (auto &ev : batch)
+        {
+            deliver(ev);
+            replay.push_back(std::move(ev));
+            if (replay.size() > replayCapacity)
+                replay.pop_front();
+        }
+        batch.clear();
+    }
+}
+
+std::shared_ptr<EventHub::Subscriber> EventHub::subscribe(const std::string &wallet, uint64_t lastEventId)
+{
+    std::shared_ptr<Subscriber> sub(new Subscriber(wallet, queueCapacity));
+
+    // under subsMutex the dispatcher is between batches, so replay + live events neither
+    // overlap nor leave a gap
+    std::lock_guard<std::mutex> lock(subsMutex);
+    if (lastEventId > 0)
+    {
+        for (const auto &ev : replay)
+            if (ev.id > lastEventId && wants(*sub, ev))
+                sub->offer(ev.frame);
+    }
+
+    if (wallet.empty())
+        everything.insert(sub);
+    else
+        byWallet[wallet].insert(sub);
+
+    LOG_DEBUG("sse subscribe", {"wallet", wallet}, {"lastEventId", lastEventId});
+    return sub;
+}
+
+void EventHub::unsubscribe(const std::shared_ptr<Subscriber> &sub)
+{
+    bool dropped;
+    {
+        std::lock_guard<std::mutex> subLock(sub->mtx);
+        dropped = sub->dropped;
+    }
+    if (dropped)
+        droppedSubscribers++;
+
+    std::lock_guard<std::mutex> lock(subsMutex);
+    if (sub->walletFilter.empty())
+    {
+        everything.erase(sub);
+        return;
+    }
+
+    auto it = byWallet.find(sub->walletFilter);
+    if (it == byWallet.end())
+        return;
+    it->second.erase(sub);
+    if (it->second.empty())
+        byWallet.erase(it);
+}
+
+size_t EventHub::subscriberCount() const
+{
+    std::lock_guard<std::mutex> lock(subsMutex);
+    size_t n = everything.size();
+    for (const auto &kv : byWallet)
+        n += kv.second.size();
+    return n;
+}
+
+nlohmann::json EventHub::stats() const
+{
+    size_t replaySize;
+    {
+        std::lock_guard<std::mutex> lock(subsMutex);
+        replaySize = replay.size();
+    }
+    return {
+        {"subscribers", subscriberCount()},
+        {"published", published.load()},
+        {"delivered", delivered.load()},
+        {"droppedSubscribers", droppedSubscribers.load()},
+        {"replay", replaySize},
+        {"queueCapacity", queueCapacity},
+    };
+}
@@ -0,0 +1,129 @@
+#ifndef EVENT_HUB_H
+#define EVENT_HUB_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../../include/json.hpp"
+
+// Fan-out of chain events to Server-Sent Events subscribers.
+//
+//   publisher (miner, admission) -> publish(): serialize once, enqueue, return
+//   dispatcher thread            -> hand the same frame to every matching subscriber queue
+//   SSE connection               -> Subscriber::next() drains its own queue
+//
+// Every event is rendered to its SSE frame ("id/event/data") exactly once and shared by
+// pointer. Subscribers have bounded queues; one that falls behind is dropped (told so, then
+// disconnected) instead of slowing the others or growing without bound. Wallet-filtered
+// subscribers are indexed by wallet, so a tx event only visits the subscribers that want it.
+// Recent events are kept for replay to clients reconnecting with Last-Event-ID.
+class EventHub
+{
+public:
+    class Subscriber
+    {
+    public:
+        enum Wait
+        {
+            EVENTS,  // out holds one or more frames
+            TIMEOUT, // nothing within the timeout (send a heartbeat)
+            DROPPED, // fell behind and was cut off
+            CLOSED   // hub shutting down
+        };
+
+        Wait next(std::string &out, std::chrono::milliseconds timeout);
+        const std::string &wallet() const { return walletFilter; }
+
+    private:
+        friend class EventHub;
+
+        Subscriber(std::string wallet, size_t capacity) : walletFilter(std::move(wallet)), capacity(capacity) {}
+        void offer(const std::shared_ptr<const std::string> &frame); // hub thread
+        void close();
+
+        std::string walletFilter; // "" = every event
+        size_t capacity;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<std::shared_ptr<const std::string>> queue;
+        bool dropped = false;
+        bool closed = false;
+    };
+
+    // queueCapacity per subscriber (UMA_SSE_QUEUE); one admitted batch lands all at once, so it
+    // must cover a full batch plus its confirmations. replay = events kept for Last-Event-ID (UMA_SSE_REPLAY)
+    explicit EventHub(size_t queueCapacity = 0, size_t replay = 0);
+    ~EventHub();
+
+    EventHub(const EventHub &) = delete;
+    EventHub &operator=(const EventHub &) = delete;
+
+    // an event with its data already serialized, so a caller can publish it from inside the
+    // critical section that fixes its order without paying for the render there
+    struct Prepared
+    {
+        std::string type;
+        std::string body;
+        std::vector<std::string> wallets;
+    };
+
+    static Prepared prepare(const std::string &type, const nlohmann::json &data, std::vector<std::string> wallets = {});
+
+    // wallets empty = broadcast; otherwise only unfiltered subscribers and those watching one of them
+    void publish(const std::string &type, const nlohmann::json &data, std::vector<std::string> wallets = {});
+    // ids are assigned in order under one leaf lock; safe to call with other locks held
+    void publish(std::vector<Prepared> events);
+
+    // events after lastEventId still in the replay window are queued straight away
+    std::shared_ptr<Subscriber> subscribe(const std::string &wallet, uint64_t lastEventId = 0);
+    void unsubscribe(const std::shared_ptr<Subscriber> &sub);
+
+    size_t subscriberCount() const;
+    nlohmann::json stats() const;
+
+private:
+    struct Event
+    {
+        uint64_t id;
+        std::shared_ptr<const std::string> frame;
+        std::vector<std::string> wallets;
+    };
+
+    void dispatchLoop();
+    void deliver(const Event &ev); // subsMutex held
+    static bool wants(const Subscriber &sub, const Event &ev);
+
+    size_t queueCapacity;
+    size_t replayCapacity;
+
+    // publisher -> dispatcher
+    std::mutex pendingMutex;
+    std::condition_variable pendingCv;
+    std::deque<Event> pending;
+    uint64_t nextId = 0;
+    bool stopping = false;
+
+    // subscribers and the replay window
+    mutable std::mutex subsMutex;
+    std::unordered_set<std::shared_ptr<Subscriber>> everything;
+    std::unordered_map<std::string, std::unordered_set<std::shared_ptr<Subscriber>>> byWallet;
+    std::deque<Event> replay;
+
+    std::thread dispatcher;
+
+    std::atomic<unsigned long long> published{0};
+    std::atomic<unsigned long long> delivered{0};
+    std::atomic<unsigned long long> droppedSubscribers{0};
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "Compression.h"
+#include "../config/Config.h"
+#include <cstdlib>
+
+const char *Compression::JSON_TYPE = "application/json; charset=utf-8";
+
+static std::string trim(const std::string &s)
+{
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos)
+        return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+// -------------------------------------------
+//  Accept-Encoding: "gzip;q=0.8, deflate, *;q=0"
+// -------------------------------------------
+Compression::Encoding Compression::negotiate(const httplib::Request &req)
+{
+    if (!req.has_header("Accept-Encoding"))
+        return IDENTITY;
+
+    const std::string &header = req.get_header_value("Accept-Encoding");
+    double gzipQ = -1, deflateQ = -1, anyQ = -1;
+
+    size_t begin = 0;
+    while (begin < header.size())
+    {
+        size_t comma = header.find(',', begin);
+        std::string item = header.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+        begin = comma == std::string::npos ? header.size() : comma + 1;
+
+        double q = 1;
+        size_t semi = item.find(';');
+        std::string coding = trim(item.substr(0, semi));
+        if (semi != std::string::npos)
+        {
+            std::string param = trim(item.substr(semi + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+                q = std::atof(param.c_str() + 2);
+        }
+
+        for (auto &c : coding)
+            c = (char)tolower((unsigned char)c);
+        if (coding == "gzip" || coding == "x-gzip")
+            gzipQ = q;
+        else if (coding == "deflate")
+            deflateQ = q;
+        else if (coding == "*")
+            anyQ = q;
+    }
+
+    if (gzipQ < 0)
+        gzipQ = anyQ;
+    if (deflateQ < 0)
+        deflateQ = anyQ;
+
+    if (gzipQ > 0 && gzipQ >= deflateQ)
+        return GZIP;
+    if (deflateQ > 0)
+        return DEFLATE;
+    return IDENTITY;
+}
+
+const char *Compression::name(Encoding enc)
+{
+    switch (enc)
+    {
+    case GZIP:
+        return "gzip";
+    case DEFLATE:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+int Compression::level(Profile profile)
+{
+    static const int standard = (int)Config::getInt("UMA_COMPRESS_LEVEL", 6);
+    static const int polled = (int)Config::getInt("UMA_COMPRESS_FAST_LEVEL", 1);
+
+    switch (profile)
+    {
+    case POLLED:
+        return polled;
+    default:
+        return standard;
+    }
+}
+
+size_t Compression::minBytes()
+{
+    static const size_t bytes = (size_t)Config::getInt("UMA_COMPRESS_MIN_BYTES", 1024);
+    return bytes;
+}
+
+void Compression::markEncoded(httplib::Response &res, Encoding enc)
+{
+    res.set_header("Vary", "Accept-Encoding");
+    if (enc != IDENTITY)
+        res.set_header("Content-Encoding", name(enc));
+}
+
+void Compression::apply(const httplib::Request &req, httplib::Response &res, Profile profile)
+{
+    if (res.body.empty() || res.has_header("Content-Encoding"))
+        return;
+    if (res.get_header_value("Content-Type") != "application/json")
+        return;
+
+    // from here on the encoding is ours, whatever we decide (set_header appends, so replace)
+    res.headers.erase("Content-Type");
+    res.set_header("Content-Type", JSON_TYPE);
+    res.set_header("Vary", "Accept-Encoding");
+
+    int lvl = level(profile);
+    Encoding enc = negotiate(req);
+    if (enc == IDENTITY || lvl <= 0 || res.body.size() < minBytes())
+        return;
+
+    std::string compressed;
+    if (!Deflate::compress(format(enc), res.body, lvl, compressed) || compressed.size() >= res.body.size())
+        return;
+
+    res.body.swap(compressed);
+    res.set_header("Content-Encoding", name(enc));
+}
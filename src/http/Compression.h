@@ -0,0 +1,48 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <string>
+#include "../../include/httplib.h"
+#include "../codec/Deflate.h"
+
+// Accept-Encoding negotiated response compression. httplib's own compressor (enabled with
+// CPPHTTPLIB_ZLIB_SUPPORT, which we keep for gzip request bodies) gzips any body typed exactly
+// "application/json" at one fixed level with no size floor, so responses that go through here
+// are typed JSON_TYPE and httplib leaves them alone; the threshold and levels below decide.
+class Compression
+{
+public:
+    enum Encoding
+    {
+        IDENTITY,
+        GZIP,
+        DEFLATE
+    };
+
+    // levels by endpoint class; 0 = never compress
+    enum Profile
+    {
+        STANDARD, // one-off bodies                  (UMA_COMPRESS_LEVEL, default 6)
+        POLLED    // changes often, fetched often     (UMA_COMPRESS_FAST_LEVEL, default 1)
+    };
+    // (sealed block groups are compressed once by the chain snapshot, UMA_COMPRESS_CACHED_LEVEL)
+
+    static const char *JSON_TYPE; // "application/json; charset=utf-8"
+
+    // gzip preferred, then deflate; honours q=0 and "*"
+    static Encoding negotiate(const httplib::Request &req);
+    static const char *name(Encoding enc);
+    static Deflate::Format format(Encoding enc) { return enc == GZIP ? Deflate::GZIP : Deflate::ZLIB; }
+
+    static int level(Profile profile);
+    static size_t minBytes(); // bodies smaller than this go out as is (UMA_COMPRESS_MIN_BYTES, default 1024)
+
+    // sets Content-Encoding (unless identity) and Vary for a response about to be sent
+    static void markEncoded(httplib::Response &res, Encoding enc);
+
+    // compress a set_content JSON body in place if the client accepts it and it is big enough;
+    // streamed bodies, bodies already encoded and other content types are left alone
+    static void apply(const httplib::Request &req, httplib::Response &res, Profile profile);
+};
+
+#endif
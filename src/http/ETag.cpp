@@ -0,0 +1,74 @@
+#include "ETag.h"
+#include <chrono>
+
+static const std::string &processEpoch()
+{
+    static const std::string epoch = [] {
+        char buf[32];
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+        snprintf(buf, sizeof(buf), "%llx", now);
+        return std::string(buf);
+    }();
+    return epoch;
+}
+
+std::string ETag::make(std::initializer_list<uint64_t> versions)
+{
+    std::string tag = "W/\"" + processEpoch();
+    for (uint64_t v : versions)
+    {
+        tag.push_back('-');
+        tag += std::to_string(v);
+    }
+    tag.push_back('"');
+    return tag;
+}
+
+// strip whitespace and the weak prefix
+static std::string opaque(const std::string &s, size_t begin, size_t end)
+{
+    while (begin < end && (s[begin] == ' ' || s[begin] == '\t'))
+        begin++;
+    while (end > begin && (s[end - 1] == ' ' || s[end - 1] == '\t'))
+        end--;
+    if (end - begin >= 2 && s.compare(begin, 2, "W/") == 0)
+        begin += 2;
+    return s.substr(begin, end - begin);
+}
+
+bool ETag::matches(const httplib::Request &req, const std::string &tag)
+{
+    if (!req.has_header("If-None-Match"))
+        return false;
+
+    const std::string &header = req.get_header_value("If-None-Match");
+    std::string want = opaque(tag, 0, tag.size());
+
+    size_t begin = 0;
+    while (begin <= header.size())
+    {
+        size_t comma = header.find(',', begin);
+        size_t end = comma == std::string::npos ? header.size() : comma;
+        std::string candidate = opaque(header, begin, end);
+        if (candidate == "*" || candidate == want)
+            return true;
+        if (comma == std::string::npos)
+            break;
+        begin = comma + 1;
+    }
+    return false;
+}
+
+bool ETag::notModified(const httplib::Request &req, httplib::Response &res, const std::string &tag)
+{
+    res.set_header("ETag", tag);
+    res.set_header("Cache-Control", "no-cache"); // always revalidate, usually for free
+
+    if (!matches(req, tag))
+        return false;
+
+    res.status = 304;
+    return true;
+}
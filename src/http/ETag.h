@@ -0,0 +1,25 @@
+#ifndef ETAG_H
+#define ETAG_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include "../../include/httplib.h"
+
+// Weak validators built from version counters (chain, mempool, per wallet). Counters restart
+// with the process, so every tag carries a per-process epoch and a restart never matches.
+class ETag
+{
+public:
+    // W/"<epoch>-<v1>-<v2>..."
+    static std::string make(std::initializer_list<uint64_t> versions);
+
+    // If-None-Match lists tag (weak comparison) or is "*"
+    static bool matches(const httplib::Request &req, const std::string &tag);
+
+    // sets ETag and Cache-Control; on a match also answers 304 and returns true so the handler
+    // can return before building a body
+    static bool notModified(const httplib::Request &req, httplib::Response &res, const std::string &tag);
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "JsonStream.h"
+#include <algorithm>
+#include <memory>
+
+// Turns the raw JSON a provider call produced into what goes on the wire: as is, or appended to
+// one gzip/zlib stream that spans the whole response.
+class StreamEncoder
+{
+public:
+    StreamEncoder(Compression::Encoding enc, int level)
+        : enc(enc), level(level), writer(Compression::format(enc)) {}
+
+    bool encoded() const { return enc != Compression::IDENTITY; }
+
+    void put(std::string &raw, std::string &out)
+    {
+        if (encoded())
+            writer.compress(raw.data(), raw.size(), level, out);
+        else
+            out.append(raw);
+        raw.clear();
+    }
+
+    void put(const DeflateSegment &seg, std::string &raw, std::string &out)
+    {
+        put(raw, out);
+        writer.append(seg, out);
+    }
+
+    void finish(std::string &raw, std::string &out)
+    {
+        put(raw, out);
+        if (encoded())
+            writer.finish(out);
+    }
+
+private:
+    Compression::Encoding enc;
+    int level;
+    Deflate::Writer writer;
+};
+
+static std::shared_ptr<StreamEncoder> startStream(const httplib::Request &req, httplib::Response &res)
+{
+    Compression::Encoding enc = Compression::negotiate(req);
+    int level = Compression::level(Compression::STANDARD);
+    if (level <= 0)
+        enc = Compression::IDENTITY;
+
+    Compression::markEncoded(res, enc);
+    return std::make_shared<StreamEncoder>(enc, level);
+}
+
+// -------------------------------------------
+//  Blocks: one array, cached JSON per block
+// -------------------------------------------
+void JsonStream::blocks(const httplib::Request &req, httplib::Response &res, ChainView chain, size_t begin, size_t end)
+{
+    end = std::min(end, chain->size());
+    if (begin > end)
+        begin = end;
+
+    // providers may be copied by httplib, so the cursor lives outside the lambda
+    struct Cursor
+    {
+        size_t next;
+        std::string raw, out;
+    };
+    auto cur = std::make_shared<Cursor>();
+    cur->next = begin;
+    auto encoder = startStream(req, res);
+
+    res.set_chunked_content_provider(Compression::JSON_TYPE, [chain, begin, end, cur, encoder](size_t, httplib::DataSink &sink)
+                                     {
+        std::string &raw = cur->raw;
+        std::string &out = cur->out;
+        out.clear();
+        if (cur->next == begin)
+            raw.push_back('[');
+
+        const size_t G = ChainSnapshot::GROUP_BLOCKS;
+        while (cur->next < end && raw.size() + out.size() < CHUNK_BYTES)
+        {
+            size_t next = cur->next;
+            // a whole precompressed group (it carries its own leading comma)
+            if (encoder->encoded() && next > begin && next % G == 0 && next + G <= end &&
+                next / G < chain->groupDeflate.size())
+            {
+                encoder->put(*chain->groupDeflate[next / G], raw, out);
+                cur->next += G;
+                continue;
+            }
+
+            if (next > begin)
+                raw.push_back(',');
+            raw.append(chain->json(cur->next++));
+        }
+
+        bool last = cur->next == end;
+        if (last)
+        {
+            raw.push_back(']');
+            encoder->finish(raw, out);
+        }
+        else
+        {
+            encoder->put(raw, out);
+        }
+
+        if (!out.empty() && !sink.write(out.data(), out.size()))
+            return false;
+        if (last)
+            sink.done();
+        return true; });
+}
+
+// -------------------------------------------
+//  Wallet history: pending first, then the chain
+//  newest block first
+// -------------------------------------------
+void JsonStream::walletHistory(const httplib::Request &req, httplib::Response &res, const std::string &walletId,
+                               std::vector<Transaction> pending, ChainView chain)
+{
+    struct Cursor
+    {
+        bool started = false;
+        bool first = true;   // no element written yet
+        size_t block;        // blocks left to scan, newest first
+        std::string raw, out;
+    };
+    auto cur = std::make_shared<Cursor>();
+    cur->block = chain->size();
+    auto txs = std::make_shared<const std::vector<Transaction>>(std::move(pending));
+    auto encoder = startStream(req, res);
+
+    res.set_chunked_content_provider(Compression::JSON_TYPE, [walletId, txs, chain, cur, encoder](size_t, httplib::DataSink &sink)
+                                     {
+        std::string &raw = cur->raw;
+        cur->out.clear();
+
+        auto emit = [&](const Transaction &tx)
+        {
+            if (!cur->first)
+                raw.push_back(',');
+            cur->first = false;
+            raw.append(tx.toJSON().dump());
+        };
+
+        if (!cur->started)
+        {
+            cur->started = true;
+            raw.append("{\"success\":true,\"transactions\":[");
+            for (const auto &tx : *txs)
+                emit(tx);
+        }
+
+        while (cur->block > 0 && raw.size() < CHUNK_BYTES)
+        {
+            for (const auto &tx : (*chain)[--cur->block].transactions)
+                if (tx.sender == walletId || tx.receiver == walletId)
+                    emit(tx);
+        }
+
+        bool last = cur->block == 0;
+        if (last)
+        {
+            raw.append("]}");
+            encoder->finish(raw, cur->out);
+        }
+        else
+        {
+            encoder->put(raw, cur->out);
+        }
+
+        if (!cur->out.empty() && !sink.write(cur->out.data(), cur->out.size()))
+            return false;
+        if (last)
+            sink.done();
+        return true; });
+}
@@ -0,0 +1,29 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <string>
+#include <vector>
+#include "../../include/httplib.h"
+#include "../blockchain/ChainSnapshot.h"
+#include "../transaction/Transaction.h"
+#include "Compression.h"
+
+// Chunked (Transfer-Encoding: chunked) JSON responses over a chain snapshot. The provider keeps
+// the snapshot and a cursor alive and emits roughly CHUNK_BYTES per call, so memory per request
+// stays flat however long the chain grows, and the first bytes go out before the last block is read.
+// With gzip/deflate each chunk is compressed as it goes; whole block groups reuse the snapshot's
+// precompressed segments.
+class JsonStream
+{
+public:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    // blocks [begin, end) as a JSON array, from the cached per-block JSON
+    static void blocks(const httplib::Request &req, httplib::Response &res, ChainView chain, size_t begin, size_t end);
+
+    // {"success":true,"transactions":[pending..., confirmed newest first...]}
+    static void walletHistory(const httplib::Request &req, httplib::Response &res, const std::string &walletId,
+                              std::vector<Transaction> pending, ChainView chain);
+};
+
+#endif
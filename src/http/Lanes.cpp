@@ -0,0 +1,248 @@
+#include "Lanes.h"
+#include "../config/Config.h"
+#include "../log/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace
+{
+    struct LaneDefaults
+    {
+        const char *threadsVar;
+        const char *queueVar;
+        long long threads;
+        long long queue;
+    };
+
+    LaneDefaults defaultsFor(Lanes::Lane lane)
+    {
+        long long hw = std::max(1u, std::thread::hardware_concurrency());
+        switch (lane)
+        {
+        case Lanes::INGRESS:
+            // handlers mostly wait on the admission pipeline, and its batches grow with the
+            // number of concurrent submitters, so this lane gets more threads than cores
+            return {"UMA_LANE_INGRESS_THREADS", "UMA_LANE_INGRESS_QUEUE", std::max(16LL, 2 * hw), 64};
+        case Lanes::POINT:
+            return {"UMA_LANE_POINT_THREADS", "UMA_LANE_POINT_QUEUE", std::max(4LL, hw), 32};
+        case Lanes::BULK:
+            return {"UMA_LANE_BULK_THREADS", "UMA_LANE_BULK_QUEUE", std::max(2LL, hw / 2), 16};
+        case Lanes::CONFIRM:
+            // each request holds its worker for a full PoW, and confirmations take turns with
+            // the miner anyway, so extra threads would only wait on each other
+            return {"UMA_LANE_CONFIRM_THREADS", "UMA_LANE_CONFIRM_QUEUE", 2, 16};
+        default:
+            return {"UMA_LANE_ADMIN_THREADS", "UMA_LANE_ADMIN_QUEUE", 2, 4};
+        }
+    }
+}
+
+const char *Lanes::name(Lane lane)
+{
+    switch (lane)
+    {
+    case INGRESS:
+        return "ingress";
+    case POINT:
+        return "point";
+    case BULK:
+        return "bulk";
+    case ADMIN:
+        return "admin";
+    case CONFIRM:
+        return "confirm";
+    default:
+        return "unknown";
+    }
+}
+
+Lanes::Lanes()
+{
+    for (int i = 0; i < COUNT; i++)
+    {
+        Lane lane = (Lane)i;
+        Pool &pool = pools[i];
+        LaneDefaults d = defaultsFor(lane);
+        size_t threads = (size_t)std::max(1LL, Config::getInt(d.threadsVar, d.threads));
+        pool.queueLimit = (size_t)std::max(0LL, Config::getInt(d.queueVar, d.queue));
+
+        std::string label = std::string("lane=\"") + name(lane) + "\"";
+        pool.shedCount = Metrics::counter("uma_lane_shed_total", "Requests refused because the lane queue was full", label);
+        pool.waitTime = Metrics::histogram("uma_lane_wait_duration_seconds", "Time a request waited for a lane worker", label);
+        Metrics::sampled("uma_lane_queued", "Requests waiting for a lane worker", "gauge", [&pool]
+                         {
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            return (double)pool.tasks.size(); }, label);
+
+        for (size_t t = 0; t < threads; t++)
+            pool.workers.emplace_back([this, &pool]()
+                                      { workerLoop(pool); });
+
+        LOG_INFO("lane ready", {"lane", name(lane)}, {"threads", threads}, {"queue", pool.queueLimit});
+    }
+}
+
+Lanes::~Lanes()
+{
+    stopping = true;
+    for (auto &pool : pools)
+    {
+        {
+            // a waiter either sees stopping in its predicate or is already waiting for this notify
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            pool.cv.notify_all();
+            pool.room.notify_all();
+        }
+        for (auto &w : pool.workers)
+            w.join();
+    }
+}
+
+void Lanes::workerLoop(Pool &pool)
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(pool.mtx);
+            pool.cv.wait(lock, [&]()
+                         { return stopping || !pool.tasks.empty(); });
+            if (stopping && pool.tasks.empty())
+                return;
+            task = std::move(pool.tasks.front());
+            pool.tasks.pop_front();
+            pool.busy++;
+        }
+
+        task(); // exceptions land in the future, rethrown on the waiting connection thread
+
+        {
+            std::lock_guard<std::mutex> lock(pool.mtx);
+            pool.busy--;
+            pool.completed++;
+        }
+        pool.room.notify_one();
+    }
+}
+
+bool Lanes::run(Lane lane, std::function<void()> job)
+{
+    return submit(lane, std::move(job), SHED);
+}
+
+bool Lanes::submit(Lane lane, std::function<void()> job, Admit admit)
+{
+    Pool &pool = pools[lane];
+    auto queued = std::chrono::steady_clock::now();
+    std::packaged_task<void()> task([&pool, queued, job = std::move(job)]()
+                                    {
+        Metrics::record(pool.waitTime, std::chrono::steady_clock::now() - queued);
+        job(); });
+    std::future<void> done = task.get_future();
+
+    {
+        std::unique_lock<std::mutex> lock(pool.mtx);
+        // a free worker takes the task straight away; only real backlog counts against the limit
+        auto full = [&]()
+        { return pool.tasks.size() >= pool.workers.size() - pool.busy + pool.queueLimit; };
+        if (admit == SHED && full())
+        {
+            pool.shed++;
+            Metrics::add(pool.shedCount);
+            return false;
+        }
+        pool.room.wait(lock, [&]()
+                       { return stopping || !full(); });
+        if (stopping)
+            return false;
+        pool.tasks.push_back(std::move(task));
+    }
+    pool.cv.notify_one();
+
+    done.get();
+    return true;
+}
+
+void Lanes::keepStreamOnLane(Lane lane, httplib::Response &res)
+{
+    // each provider call renders into a buffer on the lane; the connection thread only does the
+    // socket write, so a slow reader never holds a lane worker. Admitted streams are never shed,
+    // but each chunk waits for a queue slot like a new request would get.
+    res.content_provider_ = [this, lane, inner = std::move(res.content_provider_)](size_t offset, size_t length, httplib::DataSink &sink)
+    {
+        std::string chunk;
+        bool finished = false;
+        bool ok = true;
+        if (!submit(lane, [&]()
+               {
+            httplib::DataSink buffer;
+            buffer.write = [&](const char *data, size_t len)
+            {
+                chunk.append(data, len);
+                return true;
+            };
+            buffer.is_writable = []() { return true; };
+            buffer.done = [&]() { finished = true; };
+            buffer.done_with_trailer = [&](const httplib::Headers &) { finished = true; };
+            ok = inner(offset, length, buffer); },
+                    WAIT))
+            return false; // shutting down
+
+        if (!chunk.empty() && !sink.write(chunk.data(), chunk.size()))
+            return false;
+        if (finished)
+            sink.done();
+        return ok;
+    };
+}
+
+httplib::Server::Handler Lanes::wrap(Lane lane, httplib::Server::Handler handler,
+                                     std::function<void(httplib::Response &)> decorate)
+{
+    return [this, lane, handler = std::move(handler), decorate = std::move(decorate)](const httplib::Request &req, httplib::Response &res)
+    {
+        if (run(lane, [&]()
+                { handler(req, res); }))
+        {
+            if (res.content_provider_)
+                keepStreamOnLane(lane, res);
+            return;
+        }
+
+        LOG_WARN("lane full, request shed", {"lane", name(lane)}, {"path", req.path});
+        res.status = 503;
+        res.set_header("Retry-After", "1");
+        if (decorate)
+            decorate(res);
+        res.set_content(nlohmann::json{{"success", false}, {"message", std::string("server busy (") + name(lane) + " lane full)"}}.dump(),
+                        "application/json");
+    };
+}
+
+size_t Lanes::capacity() const
+{
+    size_t n = 0;
+    for (const auto &pool : pools)
+        n += pool.workers.size() + pool.queueLimit;
+    return n;
+}
+
+nlohmann::json Lanes::stats() const
+{
+    nlohmann::json out = nlohmann::json::object();
+    for (int i = 0; i < COUNT; i++)
+    {
+        const Pool &pool = pools[i];
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        out[name((Lane)i)] = {
+            {"threads", pool.workers.size()},
+            {"busy", pool.busy},
+            {"queued", pool.tasks.size()},
+            {"queueLimit", pool.queueLimit},
+            {"completed", pool.completed},
+            {"shed", pool.shed},
+        };
+    }
+    return out;
+}
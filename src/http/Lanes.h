@@ -0,0 +1,101 @@
+#ifndef LANES_H
+#define LANES_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../include/httplib.h"
+#include "../../include/json.hpp"
+#include "../metrics/Metrics.h"
+
+// Priority lanes: each route class runs its handlers on its own worker pool with its own
+// bounded queue, so a storm in one class can't take the workers (or the queue slots) another
+// class needs. httplib's threads only own connections; they hand the handler to the lane and
+// wait. When a lane's queue is full the request is shed with 503 + Retry-After instead of
+// piling up behind the backlog.
+//
+//   lane     routes                                      threads / queue
+//   INGRESS  transaction submission, wallet init           UMA_LANE_INGRESS_THREADS / _QUEUE
+//   POINT    balances, single block / tx, stats           UMA_LANE_POINT_THREADS / _QUEUE
+//   BULK     /chain, block lists, history, /mempool       UMA_LANE_BULK_THREADS / _QUEUE
+//   ADMIN    /mine, /admin/*                              UMA_LANE_ADMIN_THREADS / _QUEUE
+//   CONFIRM  /buy, /sell (seal their own block: one PoW)  UMA_LANE_CONFIRM_THREADS / _QUEUE
+//
+// Streamed bodies (JsonStream) are rendered chunk by chunk on the lane as well; only the
+// socket writes stay on the connection thread. A stream's later chunks are never shed (its
+// response has already started); when the queue is full they wait on the connection thread
+// for a slot instead, so streams can't grow the queue past its limit either.
+class Lanes
+{
+public:
+    enum Lane
+    {
+        INGRESS,
+        POINT,
+        BULK,
+        ADMIN,
+        CONFIRM,
+        COUNT
+    };
+
+    Lanes(); // sizes from the environment
+    ~Lanes();
+
+    Lanes(const Lanes &) = delete;
+    Lanes &operator=(const Lanes &) = delete;
+
+    // run job on lane's pool and wait for it (exceptions propagate); false = queue full, not run
+    bool run(Lane lane, std::function<void()> job);
+
+    // handler dispatched to lane; shed requests get 503, passed through decorate (e.g. CORS
+    // headers) since the handler never ran
+    httplib::Server::Handler wrap(Lane lane, httplib::Server::Handler handler,
+                                  std::function<void(httplib::Response &)> decorate = nullptr);
+
+    // workers + queue slots over all lanes: how many requests can be in the lanes at once
+    size_t capacity() const;
+
+    nlohmann::json stats() const;
+
+    static const char *name(Lane lane);
+
+private:
+    struct Pool
+    {
+        size_t queueLimit = 0;
+        std::vector<std::thread> workers;
+        std::deque<std::packaged_task<void()>> tasks;
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        std::condition_variable room;      // a task left the queue or a worker went idle
+        size_t busy = 0;                   // workers running a task (mtx)
+        unsigned long long completed = 0;  // (mtx)
+        unsigned long long shed = 0;       // (mtx)
+        Metrics::Id shedCount = 0;
+        Metrics::Id waitTime = 0;
+    };
+
+    void workerLoop(Pool &pool);
+    enum Admit
+    {
+        SHED, // queue full: refuse (new requests)
+        WAIT  // queue full: block the caller until there is room (chunks of a started stream)
+    };
+
+    // false = not run (shed, or the lanes are shutting down)
+    bool submit(Lane lane, std::function<void()> job, Admit admit);
+    // move a streamed response's body production onto the lane too
+    void keepStreamOnLane(Lane lane, httplib::Response &res);
+
+    Pool pools[COUNT];
+    std::atomic<bool> stopping{false}; // shared by every pool; set before their mtx is taken to notify
+};
+
+#endif
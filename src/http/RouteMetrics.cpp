@@ -0,0 +1,74 @@
+#include "RouteMetrics.h"
+#include "../metrics/Metrics.h"
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    constexpr Metrics::Id UNSET = ~Metrics::Id(0);
+
+    struct RouteIds
+    {
+        std::string label;
+        Metrics::Id latency;
+        Metrics::Id byClass[5] = {UNSET, UNSET, UNSET, UNSET, UNSET}; // 1xx .. 5xx, registered when first seen
+    };
+
+    // Prometheus label values escape backslash, quote and newline; route patterns are regexes
+    std::string escapeLabel(const std::string &v)
+    {
+        std::string out;
+        for (char c : v)
+        {
+            if (c == '\\' || c == '"')
+                out.push_back('\\');
+            if (c == '\n')
+            {
+                out += "\\n";
+                continue;
+            }
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    RouteIds &idsFor(const std::string &route)
+    {
+        thread_local std::unordered_map<std::string, RouteIds> local;
+        auto it = local.find(route);
+        if (it != local.end())
+            return it->second;
+
+        RouteIds ids;
+        ids.label = "route=\"" + escapeLabel(route.empty() ? "unmatched" : route) + "\"";
+        ids.latency = Metrics::histogram("uma_http_request_duration_seconds", "Handler latency by route", ids.label);
+        return local.emplace(route, std::move(ids)).first->second;
+    }
+}
+
+void RouteMetrics::observe(const httplib::Request &req, const httplib::Response &res,
+                           std::chrono::steady_clock::duration elapsed)
+{
+    RouteIds &ids = idsFor(req.matched_route);
+    int status = res.status == -1 ? 200 : res.status; // httplib fills in 200 after the handler
+    int cls = status / 100;
+    if (cls < 1 || cls > 5)
+        cls = 5;
+
+    Metrics::Id &count = ids.byClass[cls - 1];
+    if (count == UNSET)
+        count = Metrics::counter("uma_http_requests_total", "Requests by route and status class",
+                                 ids.label + ",code=\"" + std::to_string(cls) + "xx\"");
+    Metrics::add(count);
+    Metrics::record(ids.latency, elapsed);
+}
+
+httplib::Server::Handler RouteMetrics::timed(httplib::Server::Handler handler)
+{
+    return [handler = std::move(handler)](const httplib::Request &req, httplib::Response &res)
+    {
+        auto started = std::chrono::steady_clock::now();
+        handler(req, res);
+        observe(req, res, std::chrono::steady_clock::now() - started);
+    };
+}
@@ -0,0 +1,21 @@
+#ifndef ROUTE_METRICS_H
+#define ROUTE_METRICS_H
+
+#include <chrono>
+#include "../../include/httplib.h"
+
+// Per-route request counts (by status class) and latency histograms, labelled with the
+// route pattern httplib matched (req.matched_route), so /balance/(.*) is one series rather
+// than one per wallet. Series ids are cached per thread; a request only touches its own shard.
+class RouteMetrics
+{
+public:
+    // handler time including response encoding; streamed bodies are written after this
+    static void observe(const httplib::Request &req, const httplib::Response &res,
+                        std::chrono::steady_clock::duration elapsed);
+
+    // handler wrapped with observe()
+    static httplib::Server::Handler timed(httplib::Server::Handler handler);
+};
+
+#endif
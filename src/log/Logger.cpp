@@ -0,0 +1,269 @@
+#include "Logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../config/Config.h"
+
+// -----------------------------------------------------------
+//  Per-thread single-producer / single-consumer ring of lines
+// -----------------------------------------------------------
+namespace
+{
+    constexpr size_t RING_SLOTS = 4096;
+
+    struct Ring
+    {
+        std::string slots[RING_SLOTS];
+        std::atomic<size_t> head{0}; // next slot the owning thread writes
+        std::atomic<size_t> tail{0}; // next slot the writer thread reads
+        std::atomic<bool> orphaned{false};
+
+        bool push(std::string &&line)
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= RING_SLOTS)
+                return false;
+            slots[h % RING_SLOTS] = std::move(line);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        void drainInto(std::string &out)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t h = head.load(std::memory_order_acquire);
+            for (; t < h; ++t)
+                out += slots[t % RING_SLOTS];
+            tail.store(t, std::memory_order_release);
+        }
+
+        bool empty() const
+        {
+            return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+        }
+    };
+
+    // Owns the list of rings and the writer thread. Intentionally never destroyed: threads
+    // may log during static destruction, so we drain with atexit() instead.
+    struct Backend
+    {
+        std::mutex mtx; // only taken when a thread registers its ring, and by the writer
+        std::vector<std::shared_ptr<Ring>> rings;
+        std::atomic<unsigned long long> dropped{0};
+        std::thread writer;
+
+        Backend()
+        {
+            writer = std::thread([this]()
+                                 { run(); });
+            writer.detach();
+        }
+
+        std::shared_ptr<Ring> registerRing()
+        {
+            auto ring = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(mtx);
+            rings.push_back(ring);
+            return ring;
+        }
+
+        // one fwrite per pass, however many lines were queued
+        void drainOnce()
+        {
+            std::string batch;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (auto &ring : rings)
+                    ring->drainInto(batch);
+
+                // rings of exited threads are dropped once they are empty
+                for (size_t i = 0; i < rings.size();)
+                {
+                    if (rings[i]->orphaned.load(std::memory_order_acquire) && rings[i]->empty())
+                    {
+                        rings[i] = rings.back();
+                        rings.pop_back();
+                    }
+                    else
+                        i++;
+                }
+            }
+
+            if (!batch.empty())
+            {
+                std::fwrite(batch.data(), 1, batch.size(), stderr);
+                std::fflush(stderr);
+            }
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                drainOnce();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+
+        bool allEmpty()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto &ring : rings)
+                if (!ring->empty())
+                    return false;
+            return true;
+        }
+    };
+
+    Backend &backend()
+    {
+        static Backend *instance = []()
+        {
+            Backend *b = new Backend();
+            std::atexit([]()
+                        { Logger::flush(); });
+            return b;
+        }();
+        return *instance;
+    }
+
+    struct LocalRing
+    {
+        std::shared_ptr<Ring> ring;
+        ~LocalRing()
+        {
+            if (ring)
+                ring->orphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    Ring &localRing()
+    {
+        thread_local LocalRing local;
+        if (!local.ring)
+            local.ring = backend().registerRing();
+        return *local.ring;
+    }
+
+    const char *levelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::TRACE:
+            return "trace";
+        case LogLevel::DEBUG:
+            return "debug";
+        case LogLevel::INFO:
+            return "info";
+        case LogLevel::WARN:
+            return "warn";
+        case LogLevel::ERROR:
+            return "error";
+        default:
+            return "off";
+        }
+    }
+
+    void appendQuoted(std::string &out, const std::string &v)
+    {
+        out += '"';
+        for (char c : v)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (c == '\n')
+                out += "\\n";
+            else if (c == '\r')
+                out += "\\r";
+            else
+                out += c;
+        }
+        out += '"';
+    }
+}
+
+std::atomic<int> Logger::runtimeLevel{-1}; // constant-initialized, safe to read before dynamic init
+
+int Logger::initLevel()
+{
+    int level = (int)parseLevel(Config::getString("UMA_LOG_LEVEL", "info"), LogLevel::INFO);
+    int expected = -1;
+    runtimeLevel.compare_exchange_strong(expected, level, std::memory_order_relaxed);
+    return runtimeLevel.load(std::memory_order_relaxed);
+}
+
+LogLevel Logger::parseLevel(const std::string &name, LogLevel fallback)
+{
+    if (name == "trace")
+        return LogLevel::TRACE;
+    if (name == "debug")
+        return LogLevel::DEBUG;
+    if (name == "info")
+        return LogLevel::INFO;
+    if (name == "warn")
+        return LogLevel::WARN;
+    if (name == "error")
+        return LogLevel::ERROR;
+    if (name == "off")
+        return LogLevel::OFF;
+    return fallback;
+}
+
+// ts=2026-01-01T12:00:00.123Z level=info msg="..." key=value key="text"
+void Logger::write(LogLevel level, const char *msg, std::initializer_list<LogField> fields)
+{
+    auto now = std::chrono::system_clock::now();
+    time_t secs = std::chrono::system_clock::to_time_t(now);
+    int ms = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    struct tm tm;
+    gmtime_r(&secs, &tm);
+
+    char ts[96]; // room for every field at full int width, so the format can never truncate
+    std::snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, ms);
+
+    std::string line;
+    line.reserve(96);
+    line += "ts=";
+    line += ts;
+    line += " level=";
+    line += levelName(level);
+    line += " msg=";
+    appendQuoted(line, msg);
+    for (const auto &f : fields)
+    {
+        line += ' ';
+        line += f.key;
+        line += '=';
+        if (f.quoted)
+            appendQuoted(line, f.value);
+        else
+            line += f.value;
+    }
+    line += '\n';
+
+    if (!localRing().push(std::move(line)))
+        backend().dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned long long Logger::dropped()
+{
+    return backend().dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::flush()
+{
+    Backend &b = backend();
+    b.drainOnce();
+    while (!b.allEmpty())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
@@ -0,0 +1,86 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+
+// Leveled, structured, asynchronous logging.
+//
+//   LOG_DEBUG("signature verified", {"wallet", sender}, {"ok", ok});
+//
+// Each call formats one logfmt line and pushes it into a lock-free buffer owned by the
+// calling thread; a background thread drains all buffers to stderr. Nothing on the calling
+// thread ever waits on the stream. When a buffer is full the line is dropped and counted.
+//
+// Levels are filtered twice: at compile time (UMA_LOG_COMPILE_LEVEL, statements below it are
+// compiled out) and at runtime (UMA_LOG_LEVEL env: trace|debug|info|warn|error|off, default info).
+// Arguments of a filtered statement are never evaluated.
+
+enum class LogLevel
+{
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERROR = 4,
+    OFF = 5
+};
+
+#ifndef UMA_LOG_COMPILE_LEVEL
+#define UMA_LOG_COMPILE_LEVEL 1 // DEBUG and above are compiled in
+#endif
+
+struct LogField
+{
+    const char *key;
+    std::string value;
+    bool quoted;
+
+    LogField(const char *k, const std::string &v) : key(k), value(v), quoted(true) {}
+    LogField(const char *k, const char *v) : key(k), value(v ? v : ""), quoted(true) {}
+    LogField(const char *k, bool v) : key(k), value(v ? "true" : "false"), quoted(false) {}
+
+    template <typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    LogField(const char *k, T v) : key(k), value(std::to_string(v)), quoted(false) {}
+};
+
+class Logger
+{
+public:
+    static bool enabled(LogLevel level)
+    {
+        int current = runtimeLevel.load(std::memory_order_relaxed);
+        if (current < 0)
+            current = initLevel(); // first use, possibly during static initialization
+        return (int)level >= current;
+    }
+
+    static void setLevel(LogLevel level) { runtimeLevel.store((int)level, std::memory_order_relaxed); }
+    static LogLevel parseLevel(const std::string &name, LogLevel fallback);
+
+    static void write(LogLevel level, const char *msg, std::initializer_list<LogField> fields);
+
+    static unsigned long long dropped(); // lines lost to full buffers
+    static void flush();                 // block until everything queued so far is written
+
+private:
+    static std::atomic<int> runtimeLevel; // -1 until read from UMA_LOG_LEVEL
+    static int initLevel();
+};
+
+#define UMA_LOG(level, msg, ...)                                                  \
+    do                                                                            \
+    {                                                                             \
+        if ((int)(level) >= UMA_LOG_COMPILE_LEVEL && Logger::enabled(level))      \
+            Logger::write(level, msg, {__VA_ARGS__});                             \
+    } while (0)
+
+#define LOG_TRACE(msg, ...) UMA_LOG(LogLevel::TRACE, msg, ##__VA_ARGS__)
+#define LOG_DEBUG(msg, ...) UMA_LOG(LogLevel::DEBUG, msg, ##__VA_ARGS__)
+#define LOG_INFO(msg, ...) UMA_LOG(LogLevel::INFO, msg, ##__VA_ARGS__)
+#define LOG_WARN(msg, ...) UMA_LOG(LogLevel::WARN, msg, ##__VA_ARGS__)
+#define LOG_ERROR(msg, ...) UMA_LOG(LogLevel::ERROR, msg, ##__VA_ARGS__)
+
+#endif
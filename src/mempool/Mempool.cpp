@@ -0,0 +1,263 @@
+#include "Mempool.h"
+#include <chrono>
+
+// per-entry bookkeeping on top of the serialized tx: the Transaction object, map/hash nodes
+// for the three indexes and the TTL queue slot. An estimate, but a stable one.
+static constexpr size_t ENTRY_OVERHEAD = sizeof(Transaction) + 256;
+
+static long long nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Mempool::Mempool(size_t budget, long long ttl)
+{
+    maxBytes = budget;
+    ttlMs = ttl < 0 ? 0 : ttl;
+}
+
+size_t Mempool::txBytes(const Transaction &tx)
+{
+    return tx.toJSON().dump().size();
+}
+
+// ---------------------------------------------------
+//  Insert, evicting the lowest priority entries if the
+//  budget requires it (never evicts something that
+//  ranks above the incoming tx)
+// ---------------------------------------------------
+Mempool::AddResult Mempool::add(const Transaction &tx, std::vector<Transaction> *evictedOut)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return addLocked(tx, evictedOut, nullptr);
+}
+
+void Mempool::addBatch(const std::vector<Transaction> &txs,
+                       const std::function<bool(const Transaction &, double pendingOutflow)> &accept,
+                       std::vector<AddResult> &results, std::vector<Transaction> *evictedOut)
+{
+    results.clear();
+    results.reserve(txs.size());
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &tx : txs)
+        results.push_back(addLocked(tx, evictedOut, accept ? &accept : nullptr));
+}
+
+Mempool::AddResult Mempool::addLocked(const Transaction &tx, std::vector<Transaction> *evictedOut,
+                                      const std::function<bool(const Transaction &, double)> *accept)
+{
+    size_t bytes = txBytes(tx);
+    size_t memoryBytes = bytes + ENTRY_OVERHEAD;
+    PriorityKey key = keyFor(tx);
+
+    if (byId.count(tx.id))
+    {
+        duplicates++;
+        return DUPLICATE;
+    }
+
+    if (accept)
+    {
+        auto s = bySender.find(tx.sender);
+        if (!(*accept)(tx, s == bySender.end() ? 0.0 : s->second.outflow))
+            return REFUSED;
+    }
+
+    if (maxBytes > 0)
+    {
+        if (memoryBytes > maxBytes)
+        {
+            rejectedFull++;
+            return FULL;
+        }
+
+        // check first, then evict, so a rejected tx leaves the pool untouched
+        size_t freeable = 0;
+        for (auto it = byPriority.rbegin(); it != byPriority.rend() && bytesUsed - freeable + memoryBytes > maxBytes; ++it)
+        {
+            if (!(key < it->first))
+                break;
+            freeable += it->second.memoryBytes;
+        }
+        if (bytesUsed - freeable + memoryBytes > maxBytes)
+        {
+            rejectedFull++;
+            return FULL;
+        }
+
+        while (bytesUsed + memoryBytes > maxBytes)
+        {
+            auto lowest = std::prev(byPriority.end());
+            if (evictedOut)
+                evictedOut->push_back(lowest->second.tx);
+            eraseLocked(lowest);
+            evicted++;
+        }
+    }
+
+    long long admittedAt = nowMs();
+    auto it = byPriority.emplace(key, Entry{tx, bytes, memoryBytes, admittedAt}).first;
+    byId[tx.id] = it;
+
+    SenderIndex &s = bySender[tx.sender];
+    s.ids.insert(tx.id);
+    s.outflow += tx.amount + tx.fee;
+
+    if (ttlMs > 0)
+        admissionOrder.emplace_back(admittedAt, tx.id); // nothing would ever pop it without a TTL
+    bytesUsed += memoryBytes;
+    admitted++;
+    changes.fetch_add(1, std::memory_order_release);
+    return ADDED;
+}
+
+void Mempool::eraseLocked(PriorityMap::iterator it)
+{
+    const Transaction &tx = it->second.tx;
+
+    auto s = bySender.find(tx.sender);
+    if (s != bySender.end())
+    {
+        s->second.ids.erase(tx.id);
+        s->second.outflow -= tx.amount + tx.fee;
+        if (s->second.ids.empty())
+            bySender.erase(s);
+    }
+
+    bytesUsed -= it->second.memoryBytes;
+    byId.erase(tx.id);
+    byPriority.erase(it);
+    changes.fetch_add(1, std::memory_order_release);
+}
+
+void Mempool::remove(const std::vector<Transaction> &txs)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &tx : txs)
+    {
+        auto found = byId.find(tx.id);
+        if (found != byId.end())
+            eraseLocked(found->second);
+    }
+}
+
+size_t Mempool::expire()
+{
+    if (ttlMs == 0)
+        return 0;
+
+    long long cutoff = nowMs() - ttlMs;
+    size_t dropped = 0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    while (!admissionOrder.empty() && admissionOrder.front().first <= cutoff)
+    {
+        auto found = byId.find(admissionOrder.front().second);
+        // entries already mined/evicted leave a stale slot behind; skip those
+        if (found != byId.end() && found->second->second.admittedMs == admissionOrder.front().first)
+        {
+            eraseLocked(found->second);
+            dropped++;
+        }
+        admissionOrder.pop_front();
+    }
+
+    // the queue only shrinks from the front; compact it if stale slots pile up behind live ones
+    if (admissionOrder.size() > 2 * byId.size() + 1024)
+    {
+        std::deque<std::pair<long long, std::string>> live;
+        for (const auto &slot : admissionOrder)
+        {
+            auto found = byId.find(slot.second);
+            if (found != byId.end() && found->second->second.admittedMs == slot.first)
+                live.push_back(slot);
+        }
+        admissionOrder.swap(live);
+    }
+
+    expired += dropped;
+    return dropped;
+}
+
+std::vector<Transaction> Mempool::selectForBlock(size_t maxTx, size_t maxBlockBytes) const
+{
+    std::vector<Transaction> out;
+    size_t bytes = 0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &kv : byPriority)
+    {
+        if (out.size() >= maxTx)
+            break;
+        if (bytes + kv.second.bytes > maxBlockBytes)
+            continue;
+
+        out.push_back(kv.second.tx);
+        bytes += kv.second.bytes;
+    }
+    return out;
+}
+
+void Mempool::forEach(const std::function<void(const Transaction &)> &fn) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &kv : byPriority)
+        fn(kv.second.tx);
+}
+
+bool Mempool::find(const std::string &txid, Transaction &out) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto found = byId.find(txid);
+    if (found == byId.end())
+        return false;
+    out = found->second->second.tx;
+    return true;
+}
+
+bool Mempool::containsAll(const std::vector<Transaction> &txs) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &tx : txs)
+        if (!byId.count(tx.id))
+            return false;
+    return true;
+}
+
+double Mempool::pendingOutflow(const std::string &sender) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto s = bySender.find(sender);
+    return s == bySender.end() ? 0.0 : s->second.outflow;
+}
+
+std::vector<Transaction> Mempool::snapshot() const
+{
+    std::vector<Transaction> out;
+    std::lock_guard<std::mutex> lock(mtx);
+    out.reserve(byPriority.size());
+    for (const auto &kv : byPriority)
+        out.push_back(kv.second.tx);
+    return out;
+}
+
+bool Mempool::empty() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return byPriority.empty();
+}
+
+size_t Mempool::size() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return byPriority.size();
+}
+
+Mempool::Stats Mempool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return Stats{byPriority.size(), bytesUsed, maxBytes, admitted, evicted, expired, rejectedFull, duplicates, admissionOrder.size()};
+}
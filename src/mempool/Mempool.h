@@ -0,0 +1,135 @@
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../transaction/Transaction.h"
+
+// Pending (unconfirmed) transactions kept in block-inclusion priority order:
+// highest fee first, then oldest first. Indexed by txid and by sender, bounded by a
+// memory budget (lowest priority evicted first) and a TTL. Safe to call from any thread.
+class Mempool
+{
+public:
+    enum AddResult
+    {
+        ADDED,
+        DUPLICATE, // txid already pending
+        FULL,      // over budget and the tx ranks below everything already pending
+        REFUSED    // addBatch: the accept callback declined it
+    };
+
+    struct Stats
+    {
+        size_t count;
+        size_t bytes;
+        size_t maxBytes;
+        unsigned long long admitted;
+        unsigned long long evicted;
+        unsigned long long expired;
+        unsigned long long rejectedFull;
+        unsigned long long duplicates;
+        size_t ttlSlots; // TTL queue length, stale slots included (always 0 without a TTL)
+    };
+
+    // maxBytes: memory budget for pending entries (0 = unbounded)
+    // ttlMs: how long a tx may wait for a block before it is dropped (0 = forever)
+    Mempool(size_t maxBytes, long long ttlMs);
+
+    // evicted receives the transactions pushed out to make room (may be null)
+    AddResult add(const Transaction &tx, std::vector<Transaction> *evicted = nullptr);
+    // Insert txs in order under one lock acquisition; results[i] is for txs[i]. accept (optional)
+    // runs under the lock with the sender's pending outflow, which already counts txs added
+    // earlier in the same batch.
+    void addBatch(const std::vector<Transaction> &txs,
+                  const std::function<bool(const Transaction &, double pendingOutflow)> &accept,
+                  std::vector<AddResult> &results, std::vector<Transaction> *evicted = nullptr);
+    void remove(const std::vector<Transaction> &txs); // drop transactions that made it into a block
+    size_t expire();                                   // drop entries older than the TTL, returns how many
+
+    // Highest-priority transactions that fit in maxTx / maxBytes. A transaction that doesn't fit
+    // the remaining byte budget is skipped so smaller ones behind it still get a chance.
+    std::vector<Transaction> selectForBlock(size_t maxTx, size_t maxBytes) const;
+
+    // visit pending transactions in priority order without copying them; fn must not call back into the mempool
+    void forEach(const std::function<void(const Transaction &)> &fn) const;
+    bool find(const std::string &txid, Transaction &out) const;
+    bool containsAll(const std::vector<Transaction> &txs) const;
+    double pendingOutflow(const std::string &sender) const; // amount + fee of everything the sender has pending
+
+    std::vector<Transaction> snapshot() const; // priority order
+    // bumped on every admission and removal; lock-free, read it before the contents it describes
+    uint64_t version() const { return changes.load(std::memory_order_acquire); }
+    bool empty() const;
+    size_t size() const;
+    Stats stats() const;
+
+    // approximate on-wire/on-disk size of a transaction, used for block byte limits
+    static size_t txBytes(const Transaction &tx);
+
+private:
+    struct PriorityKey
+    {
+        double fee;
+        long long timestamp;
+        std::string id;
+
+        bool operator<(const PriorityKey &o) const
+        {
+            if (fee != o.fee)
+                return fee > o.fee;
+            if (timestamp != o.timestamp)
+                return timestamp < o.timestamp;
+            return id < o.id;
+        }
+    };
+
+    struct Entry
+    {
+        Transaction tx;
+        size_t bytes;       // serialized size (block limits)
+        size_t memoryBytes; // serialized size + container overhead (memory budget)
+        long long admittedMs;
+    };
+
+    struct SenderIndex
+    {
+        std::unordered_set<std::string> ids;
+        double outflow = 0;
+    };
+
+    using PriorityMap = std::map<PriorityKey, Entry>;
+
+    static PriorityKey keyFor(const Transaction &tx) { return {tx.fee, tx.timestamp, tx.id}; }
+
+    AddResult addLocked(const Transaction &tx, std::vector<Transaction> *evictedOut,
+                        const std::function<bool(const Transaction &, double)> *accept);
+    void eraseLocked(PriorityMap::iterator it);
+
+    mutable std::mutex mtx;
+    std::atomic<uint64_t> changes{0};
+    PriorityMap byPriority;
+    std::unordered_map<std::string, PriorityMap::iterator> byId;
+    std::unordered_map<std::string, SenderIndex> bySender;
+    std::deque<std::pair<long long, std::string>> admissionOrder; // (admittedMs, txid) for TTL, lazily pruned; unused when ttlMs == 0
+
+    size_t maxBytes;
+    long long ttlMs;
+    size_t bytesUsed = 0;
+
+    unsigned long long admitted = 0;
+    unsigned long long evicted = 0;
+    unsigned long long expired = 0;
+    unsigned long long rejectedFull = 0;
+    unsigned long long duplicates = 0;
+};
+
+#endif
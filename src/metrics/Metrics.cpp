@@ -0,0 +1,315 @@
+#include "Metrics.h"
+#include "../log/Logger.h"
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    // ---- HDR bucket layout: values < 8 exact, then 8 sub-buckets per power of two ----
+    constexpr int SUB_BITS = 3;
+    constexpr uint64_t SUB = 1u << SUB_BITS;
+    constexpr int MAX_EXP = 35; // 2^35 us ~ 9.5h; larger values land in the last bucket
+    constexpr size_t BUCKETS = SUB + (MAX_EXP - SUB_BITS + 1) * SUB;
+
+    // export boundaries: 2^3 us .. 2^26 us (~67s), plus +Inf
+    constexpr int EXPORT_MIN_EXP = 3;
+    constexpr int EXPORT_MAX_EXP = 26;
+
+    size_t bucketOf(uint64_t v)
+    {
+        if (v < SUB)
+            return (size_t)v;
+        int e = 63 - __builtin_clzll(v);
+        if (e > MAX_EXP)
+            return BUCKETS - 1;
+        return SUB + (size_t)(e - SUB_BITS) * SUB + (size_t)((v >> (e - SUB_BITS)) & (SUB - 1));
+    }
+
+    // exclusive upper bound of bucket b, in us
+    uint64_t bucketUpper(size_t b)
+    {
+        if (b < SUB)
+            return b + 1;
+        int e = SUB_BITS + (int)((b - SUB) / SUB);
+        uint64_t sub = (b - SUB) % SUB;
+        return (SUB + sub + 1) << (e - SUB_BITS);
+    }
+
+    // single writer per cell: the owning thread; scrapes only load
+    inline void bump(std::atomic<uint64_t> &cell, uint64_t n)
+    {
+        cell.store(cell.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    struct HistogramCells
+    {
+        std::atomic<uint64_t> buckets[BUCKETS]{};
+        std::atomic<uint64_t> sum{0};
+    };
+
+    struct Shard
+    {
+        std::atomic<uint64_t> counters[Metrics::MAX_COUNTERS]{};
+        std::atomic<HistogramCells *> histograms[Metrics::MAX_HISTOGRAMS]{}; // allocated by the owner on first use
+        std::atomic<bool> orphaned{false};
+    };
+
+    struct Series
+    {
+        std::string name;
+        std::string help;
+        std::string labels;
+    };
+
+    struct Sampled
+    {
+        Series series;
+        const char *type;
+        std::function<double()> read;
+    };
+
+    // the last slot of each table is a sink for registrations past the limit; never exported
+    constexpr Metrics::Id COUNTER_SINK = Metrics::MAX_COUNTERS - 1;
+    constexpr Metrics::Id HISTOGRAM_SINK = Metrics::MAX_HISTOGRAMS - 1;
+
+    struct Registry
+    {
+        std::mutex mtx;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<Series> counters;
+        std::vector<Series> histograms;
+        std::vector<Sampled> sampled;
+        std::unordered_map<std::string, Metrics::Id> counterIds;
+        std::unordered_map<std::string, Metrics::Id> histogramIds;
+
+        Shard *claimShard()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto &s : shards)
+            {
+                bool expected = true;
+                if (s->orphaned.compare_exchange_strong(expected, false, std::memory_order_acq_rel))
+                    return s.get(); // keeps the exited thread's totals and adds to them
+            }
+            shards.push_back(std::make_unique<Shard>());
+            return shards.back().get();
+        }
+
+        Metrics::Id registerSeries(std::vector<Series> &table, std::unordered_map<std::string, Metrics::Id> &ids,
+                                   Metrics::Id sink, const std::string &name, const std::string &help, const std::string &labels)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::string key = name + "{" + labels + "}";
+            auto it = ids.find(key);
+            if (it != ids.end())
+                return it->second;
+            if (table.size() >= sink)
+            {
+                LOG_WARN("metrics table full, series not exported", {"name", name}, {"labels", labels});
+                return sink;
+            }
+            Metrics::Id id = (Metrics::Id)table.size();
+            table.push_back(Series{name, help, labels});
+            ids.emplace(std::move(key), id);
+            return id;
+        }
+    };
+
+    Registry &registry()
+    {
+        static Registry *instance = new Registry(); // outlives every thread's exit path
+        return *instance;
+    }
+
+    struct LocalShard
+    {
+        Shard *shard = nullptr;
+        ~LocalShard()
+        {
+            if (shard)
+                shard->orphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    Shard &localShard()
+    {
+        thread_local LocalShard local;
+        if (!local.shard)
+            local.shard = registry().claimShard();
+        return *local.shard;
+    }
+
+    std::string number(double v)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.9g", v);
+        return buf;
+    }
+
+    std::string withLabels(const std::string &labels, const std::string &extra = "")
+    {
+        if (labels.empty() && extra.empty())
+            return "";
+        if (labels.empty() || extra.empty())
+            return "{" + labels + extra + "}";
+        return "{" + labels + "," + extra + "}";
+    }
+
+    struct Family
+    {
+        std::string help;
+        std::string type;
+        std::string lines;
+    };
+}
+
+Metrics::Id Metrics::counter(const std::string &name, const std::string &help, const std::string &labels)
+{
+    Registry &r = registry();
+    return r.registerSeries(r.counters, r.counterIds, COUNTER_SINK, name, help, labels);
+}
+
+Metrics::Id Metrics::histogram(const std::string &name, const std::string &help, const std::string &labels)
+{
+    Registry &r = registry();
+    return r.registerSeries(r.histograms, r.histogramIds, HISTOGRAM_SINK, name, help, labels);
+}
+
+void Metrics::sampled(const std::string &name, const std::string &help, const char *type,
+                      std::function<double()> read, const std::string &labels)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+    r.sampled.push_back(Sampled{Series{name, help, labels}, type, std::move(read)});
+}
+
+void Metrics::add(Id counter, uint64_t n)
+{
+    bump(localShard().counters[counter], n);
+}
+
+void Metrics::record(Id histogram, uint64_t micros)
+{
+    Shard &shard = localShard();
+    HistogramCells *cells = shard.histograms[histogram].load(std::memory_order_relaxed);
+    if (!cells)
+    {
+        cells = new HistogramCells();
+        shard.histograms[histogram].store(cells, std::memory_order_release); // published to scrapes
+    }
+    bump(cells->buckets[bucketOf(micros)], 1);
+    bump(cells->sum, micros);
+}
+
+void Metrics::record(Id histogram, std::chrono::steady_clock::duration elapsed)
+{
+    record(histogram, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+std::string Metrics::scrape()
+{
+    Registry &r = registry();
+    std::map<std::string, Family> families;
+    std::vector<Sampled> sampled;
+
+    auto family = [&](const Series &s, const char *type) -> Family &
+    {
+        Family &f = families[s.name];
+        if (f.type.empty())
+        {
+            f.help = s.help;
+            f.type = type;
+        }
+        return f;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(r.mtx);
+
+        for (size_t id = 0; id < r.counters.size(); id++)
+        {
+            uint64_t total = 0;
+            for (auto &shard : r.shards)
+                total += shard->counters[id].load(std::memory_order_relaxed);
+            family(r.counters[id], "counter").lines +=
+                r.counters[id].name + withLabels(r.counters[id].labels) + " " + std::to_string(total) + "\n";
+        }
+
+        std::vector<uint64_t> buckets(BUCKETS);
+        for (size_t id = 0; id < r.histograms.size(); id++)
+        {
+            std::fill(buckets.begin(), buckets.end(), 0);
+            uint64_t sum = 0;
+            for (auto &shard : r.shards)
+            {
+                HistogramCells *cells = shard->histograms[id].load(std::memory_order_acquire);
+                if (!cells)
+                    continue;
+                for (size_t b = 0; b < BUCKETS; b++)
+                    buckets[b] += cells->buckets[b].load(std::memory_order_relaxed);
+                sum += cells->sum.load(std::memory_order_relaxed);
+            }
+
+            const Series &s = r.histograms[id];
+            std::string &out = family(s, "histogram").lines;
+            uint64_t count = 0;
+            size_t b = 0;
+            for (int e = EXPORT_MIN_EXP; e <= EXPORT_MAX_EXP; e++)
+            {
+                for (; b < BUCKETS && bucketUpper(b) <= (1ull << e); b++)
+                    count += buckets[b];
+                out += s.name + "_bucket" + withLabels(s.labels, "le=\"" + number((double)(1ull << e) / 1e6) + "\"") +
+                       " " + std::to_string(count) + "\n";
+            }
+            for (; b < BUCKETS; b++)
+                count += buckets[b];
+            out += s.name + "_bucket" + withLabels(s.labels, "le=\"+Inf\"") + " " + std::to_string(count) + "\n";
+            out += s.name + "_sum" + withLabels(s.labels) + " " + number((double)sum / 1e6) + "\n";
+            out += s.name + "_count" + withLabels(s.labels) + " " + std::to_string(count) + "\n";
+
+            // quantiles at full HDR resolution (bucket upper bound, so never understated)
+            Family &q = family(Series{s.name + "_quantile", "HDR quantiles of " + s.name, ""}, "gauge");
+            static const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+            for (double quantile : QUANTILES)
+            {
+                double value = 0;
+                if (count > 0)
+                {
+                    uint64_t rank = (uint64_t)(quantile * (double)count + 0.999999);
+                    uint64_t seen = 0;
+                    for (size_t i = 0; i < BUCKETS; i++)
+                    {
+                        seen += buckets[i];
+                        if (seen >= rank)
+                        {
+                            value = (double)bucketUpper(i) / 1e6;
+                            break;
+                        }
+                    }
+                }
+                q.lines += s.name + "_quantile" + withLabels(s.labels, "quantile=\"" + number(quantile) + "\"") +
+                           " " + number(value) + "\n";
+            }
+        }
+
+        sampled = r.sampled;
+    }
+
+    // callbacks take their own locks (mempool, caches), so never under the registry mutex
+    for (const auto &sm : sampled)
+        family(sm.series, sm.type).lines += sm.series.name + withLabels(sm.series.labels) + " " + number(sm.read()) + "\n";
+
+    std::string out;
+    for (const auto &kv : families)
+    {
+        out += "# HELP " + kv.first + " " + kv.second.help + "\n";
+        out += "# TYPE " + kv.first + " " + kv.second.type + "\n";
+        out += kv.second.lines;
+    }
+    return out;
+}
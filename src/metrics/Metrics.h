@@ -0,0 +1,47 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Process-wide counters and latency histograms, exported in Prometheus text format.
+//
+//   static const Metrics::Id hashes = Metrics::counter("uma_mining_hashes_total", "PoW hashes computed");
+//   Metrics::add(hashes, n);
+//
+// Every thread records into its own shard: plain relaxed loads and stores on memory no
+// other thread writes, so recording never takes a lock or a contended cache line. A scrape
+// walks the shards and sums them; it only shares a mutex with thread start-up and metric
+// registration, never with recording. Shards of exited threads are handed to the next new
+// thread, so totals survive thread churn.
+//
+// Histograms are HDR-style: log-linear buckets with 8 sub-buckets per power of two (values
+// within 12.5%), 1us to ~9.5h. They are exported as cumulative power-of-two buckets plus
+// p50/p90/p99/p999 computed from the full resolution.
+class Metrics
+{
+public:
+    using Id = uint32_t;
+
+    // labels are preformatted: R"(route="/chain")"; same name + labels returns the same id
+    static Id counter(const std::string &name, const std::string &help, const std::string &labels = "");
+    static Id histogram(const std::string &name, const std::string &help, const std::string &labels = "");
+
+    // read at scrape time; type is "gauge" or "counter" (for totals kept elsewhere)
+    static void sampled(const std::string &name, const std::string &help, const char *type,
+                        std::function<double()> read, const std::string &labels = "");
+
+    static void add(Id counter, uint64_t n = 1);
+    static void record(Id histogram, uint64_t micros);
+    static void record(Id histogram, std::chrono::steady_clock::duration elapsed);
+
+    // Prometheus text exposition (version 0.0.4)
+    static std::string scrape();
+
+    static constexpr size_t MAX_COUNTERS = 512;
+    static constexpr size_t MAX_HISTOGRAMS = 128;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "BlockTemplate.h"
+#include "../mempool/Mempool.h"
+#include <chrono>
+#include <algorithm>
+
+static long long nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+BlockTemplateBuilder::BlockTemplateBuilder(size_t minTx, long long minIntervalMs, size_t blockMaxTx, size_t blockMaxBytes)
+{
+    restartMinTx = minTx == 0 ? 1 : minTx;
+    restartMinIntervalMs = minIntervalMs < 0 ? 0 : minIntervalMs;
+    maxTx = blockMaxTx == 0 ? 1 : blockMaxTx;
+    maxBlockBytes = blockMaxBytes == 0 ? 1 : blockMaxBytes;
+}
+
+// ---------------------------------------------------
+//  Rebuild from the mempool (new tip, full template, evictions)
+// ---------------------------------------------------
+void BlockTemplateBuilder::reset(int index, const std::string &previousHash, const std::vector<Transaction> &selected, bool invalidate)
+{
+    size_t bytes = 0;
+    double fees = 0;
+    double lowest = selected.empty() ? 0 : selected.front().fee;
+    for (const auto &tx : selected)
+    {
+        bytes += Mempool::txBytes(tx);
+        fees += tx.fee;
+        lowest = std::min(lowest, tx.fee);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    current.version++;
+    current.index = index;
+    current.previousHash = previousHash;
+    current.transactions = selected;
+    current.bytes = bytes;
+    current.totalFees = fees;
+    current.lowestFee = lowest;
+
+    if (invalidate)
+        invalidVersion.store(current.version, std::memory_order_release);
+    currentVersion.store(current.version, std::memory_order_release);
+}
+
+// ---------------------------------------------------
+//  Incremental update: append without touching the rest
+// ---------------------------------------------------
+bool BlockTemplateBuilder::addTransaction(const Transaction &tx, size_t txBytes)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (current.transactions.size() >= maxTx || current.bytes + txBytes > maxBlockBytes)
+        return tx.fee <= current.lowestFee; // stays in the mempool for a later block
+
+    // appended at the end: a new tx never outranks older ones with the same fee, and a higher
+    // fee only reorders inside the block, which doesn't change what gets confirmed
+    current.version++;
+    current.transactions.push_back(tx);
+    current.bytes += txBytes;
+    current.totalFees += tx.fee;
+    current.lowestFee = current.transactions.size() == 1 ? tx.fee : std::min(current.lowestFee, tx.fee);
+
+    currentVersion.store(current.version, std::memory_order_release);
+    return true;
+}
+
+BlockTemplate BlockTemplateBuilder::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return current;
+}
+
+bool BlockTemplateBuilder::shouldRestart(const BlockTemplate &mined) const
+{
+    uint64_t latest = currentVersion.load(std::memory_order_acquire);
+    if (latest == mined.version)
+        return false;
+
+    // someone else extended the chain or dropped some of our transactions
+    if (isInvalidated(mined))
+        return true;
+
+    // PoW attempts are memoryless, so restarting loses no progress; the only cost is a
+    // slightly larger block to hash. Only worth it once enough transactions queued up.
+    size_t waiting = 0;
+    double feeGain = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (current.transactions.size() > mined.transactions.size())
+            waiting = current.transactions.size() - mined.transactions.size();
+        feeGain = current.totalFees - mined.totalFees;
+    }
+    if (waiting < restartMinTx && feeGain <= 0)
+        return false;
+
+    long long now = nowMs();
+    long long last = lastRestartMs.load(std::memory_order_relaxed);
+    if (now - last < restartMinIntervalMs)
+        return false;
+
+    lastRestartMs.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+bool BlockTemplateBuilder::isInvalidated(const BlockTemplate &mined) const
+{
+    return invalidVersion.load(std::memory_order_acquire) > mined.version;
+}
+
+bool BlockTemplateBuilder::containsAny(const std::vector<Transaction> &txs) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto &tx : txs)
+        for (const auto &mine : current.transactions)
+            if (mine.id == tx.id)
+                return true;
+    return false;
+}
@@ -0,0 +1,70 @@
+#ifndef BLOCK_TEMPLATE_H
+#define BLOCK_TEMPLATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../transaction/Transaction.h"
+
+// A candidate block ready to be mined: the header fields that are known up front plus the
+// transaction set taken from the mempool. Miners work on a copy and compare versions to
+// find out whether a fresher template is available.
+struct BlockTemplate
+{
+    uint64_t version = 0;
+    int index = 0;
+    std::string previousHash;
+    std::vector<Transaction> transactions; // priority order, within the block limits
+    size_t bytes = 0;
+    double totalFees = 0;
+    double lowestFee = 0;
+};
+
+// Keeps the current template in sync with the mempool and chain tip.
+// New transactions are appended incrementally while they fit; a new tip (or a full template)
+// is rebuilt from the mempool's priority order.
+class BlockTemplateBuilder
+{
+public:
+    // restartMinTx: how many new transactions make restarting an in-flight miner worthwhile
+    // restartMinIntervalMs: lower bound between restarts so a burst of submissions doesn't thrash the miner
+    // maxTx / maxBytes: per-block limits for mempool transactions (the reward tx is added on top)
+    BlockTemplateBuilder(size_t restartMinTx, long long restartMinIntervalMs, size_t maxTx, size_t maxBytes);
+
+    // selected must already be in priority order and within the limits (Mempool::selectForBlock).
+    // invalidate: templates handed out earlier must not be committed (new tip, or some of their
+    // transactions were evicted/expired from the mempool)
+    void reset(int index, const std::string &previousHash, const std::vector<Transaction> &selected, bool invalidate);
+
+    // Appends the tx if it fits. Returns false when it doesn't fit but pays more than the cheapest
+    // tx in the template; the caller should then rebuild from the mempool so it can displace it.
+    bool addTransaction(const Transaction &tx, size_t txBytes);
+
+    size_t maxTransactions() const { return maxTx; }
+    size_t maxBytes() const { return maxBlockBytes; }
+
+    BlockTemplate snapshot() const;
+    uint64_t version() const { return currentVersion.load(std::memory_order_acquire); }
+
+    // Polled by miners working on `mined`. True when the template was invalidated (the work is
+    // now useless) or enough new transactions / fees arrived to be worth a restart.
+    bool shouldRestart(const BlockTemplate &mined) const;
+    bool isInvalidated(const BlockTemplate &mined) const;
+    bool containsAny(const std::vector<Transaction> &txs) const;
+
+private:
+    mutable std::mutex mtx;
+    BlockTemplate current;
+    std::atomic<uint64_t> currentVersion{0};
+    std::atomic<uint64_t> invalidVersion{0}; // templates older than this must not be committed
+    mutable std::atomic<long long> lastRestartMs{0}; // restart clock shared between miners
+
+    size_t restartMinTx;
+    long long restartMinIntervalMs;
+    size_t maxTx;
+    size_t maxBlockBytes;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "Difficulty.h"
+#include <algorithm>
+
+// a single retarget step may not move the target by more than this factor either way,
+// so one unusually lucky (or slow) block can't swing the difficulty wildly
+static constexpr long double MAX_ADJUST = 4.0L;
+
+Difficulty::Difficulty(long long targetBlockMs, size_t window, uint64_t initialTarget)
+{
+    targetMs = std::max(1LL, targetBlockMs);
+    maxWindow = std::max<size_t>(1, window);
+    target = std::max(MIN_TARGET, initialTarget);
+}
+
+double Difficulty::workFor(uint64_t t)
+{
+    if (t == 0)
+        return (double)MAX_TARGET;
+    return (double)((long double)MAX_TARGET / (long double)t);
+}
+
+void Difficulty::recordBlock(uint64_t blockTarget, long long solveTimeMs)
+{
+    retargeted = true;
+    samples.push_back({blockTarget, std::max(1LL, solveTimeMs)});
+    while (samples.size() > maxWindow)
+        samples.pop_front();
+
+    retarget();
+}
+
+void Difficulty::reset(uint64_t startTarget)
+{
+    samples.clear();
+    retargeted = false;
+    target = std::max(MIN_TARGET, startTarget);
+}
+
+bool Difficulty::follow(uint64_t blockTarget, long long solveTimeMs)
+{
+    if (blockTarget == MAX_TARGET && !retargeted)
+        return true; // legacy prefix: mined before targets existed, not part of the window
+    if (blockTarget != currentTarget())
+        return false;
+
+    recordBlock(blockTarget, solveTimeMs);
+    return true;
+}
+
+// -----------------------------------------------------------
+//  hashRate = sum(work) / sum(time) over the window,
+//  next work = hashRate * targetMs  ->  next target = MAX / work
+// -----------------------------------------------------------
+void Difficulty::retarget()
+{
+    long double totalWork = 0;
+    long double totalMs = 0;
+    for (const auto &s : samples)
+    {
+        totalWork += workFor(s.target);
+        totalMs += s.solveTimeMs;
+    }
+
+    long double hashesPerMs = totalWork / totalMs;
+    long double nextWork = std::max(1.0L, hashesPerMs * targetMs);
+    long double next = (long double)MAX_TARGET / nextWork;
+
+    long double current = currentTarget();
+    next = std::min(next, current * MAX_ADJUST);
+    next = std::max(next, current / MAX_ADJUST);
+    next = std::max(next, (long double)MIN_TARGET);
+
+    // MAX_TARGET marks pre-retarget blocks, so the schedule itself never produces it
+    target = next >= (long double)(MAX_TARGET - 1) ? MAX_TARGET - 1 : (uint64_t)next;
+}
@@ -0,0 +1,59 @@
+#ifndef DIFFICULTY_H
+#define DIFFICULTY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <atomic>
+
+// Proof of work target: a block is valid when its numeric hash value is <= target.
+// A smaller target means more work. "difficulty" is reported as the expected number
+// of hashes needed to find a block (MAX_TARGET / target).
+class Difficulty
+{
+public:
+    static constexpr uint64_t MAX_TARGET = UINT64_MAX;
+    static constexpr uint64_t MIN_TARGET = MAX_TARGET >> 40; // ~1e12 expected hashes, keeps the nonce loop bounded
+    static constexpr uint64_t INITIAL_TARGET = MAX_TARGET >> 15; // ~32k hashes, close to the old "11111" prefix rule
+
+    // targetBlockMs: desired time to solve one block
+    // window: number of recent blocks used to estimate the hash rate
+    Difficulty(long long targetBlockMs, size_t window, uint64_t initialTarget = INITIAL_TARGET);
+
+    // safe to read while another thread records a block; recordBlock/reset need external locking
+    uint64_t currentTarget() const { return target.load(std::memory_order_relaxed); }
+    double currentDifficulty() const { return workFor(currentTarget()); }
+    long long targetBlockMs() const { return targetMs; }
+    size_t windowSize() const { return maxWindow; }
+
+    // Feed a sealed block into the moving window and retarget for the next one.
+    void recordBlock(uint64_t blockTarget, long long solveTimeMs);
+
+    // Clear the window and start again from the given target (used when replaying a loaded chain).
+    void reset(uint64_t startTarget);
+
+    // The retarget schedule as a chain rule: feed blocks in chain order, starting from a fresh
+    // instance (or reset(INITIAL_TARGET)). Each block must carry the target the preceding blocks
+    // imply; MAX_TARGET (blocks from before retargeting) only on the prefix before the first
+    // retargeted block. false = the block breaks the schedule (nothing recorded).
+    bool follow(uint64_t blockTarget, long long solveTimeMs);
+
+    static double workFor(uint64_t target);
+
+private:
+    struct Sample
+    {
+        uint64_t target;
+        long long solveTimeMs;
+    };
+
+    std::deque<Sample> samples;
+    long long targetMs;
+    size_t maxWindow;
+    std::atomic<uint64_t> target;
+    bool retargeted = false; // a block with a real target was recorded; MAX_TARGET no longer allowed
+
+    void retarget();
+};
+
+#endif
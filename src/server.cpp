@@ -5,13 +5,48 @@
 #include "./blockchain/Blockchain.h"
 #include "./wallet/WalletManager.h"
 #include "./crypto/Crypto.h"
+#include "./crypto/VerifyService.h"
+#include "./admission/AdmissionPipeline.h"
+#include "./events/EventHub.h"
+#include "./http/JsonStream.h"
+#include "./http/ETag.h"
+#include "./http/Compression.h"
+#include "./http/RouteMetrics.h"
+#include "./http/Lanes.h"
+#include "./metrics/Metrics.h"
+#include "./log/Logger.h"
+#include "./config/Config.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
 #include <openssl/bio.h>
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 
 WalletManager walletManager;
 
 Blockchain blockchain; // global blockchain instance or object
 
+// chain revalidation state (POST /admin/revalidate, UMA_VALIDATE_ON_START); one run at a time
+static ValidationProgress revalidation;
+static std::atomic<bool> revalidationRunning{false};
+static std::mutex revalidationMutex;
+static nlohmann::json lastRevalidation; // report of the last finished run (revalidationMutex)
+
+// admin endpoints require X-Admin-Token to match UMA_ADMIN_TOKEN; with no token configured
+// they are disabled rather than open
+static bool isAdminRequest(const httplib::Request &req)
+{
+    static const std::string token = Config::getString("UMA_ADMIN_TOKEN", "");
+    if (token.empty())
+        return false;
+    std::string given = req.get_header_value("X-Admin-Token");
+    return given.size() == token.size() && CRYPTO_memcmp(given.data(), token.data(), token.size()) == 0;
+}
+
 // exchange rate: 1 USD = UMA_PER_USD UmaCoin
 static constexpr double UMA_PER_USD = 0.1; // change as you like
 
@@ -48,7 +83,44 @@ static double umaToUsd(double uma)
 int main()
 {
 
+    // optional full revalidation before serving anything
+    if (Config::getInt("UMA_VALIDATE_ON_START", 0))
+    {
+        revalidationRunning = true;
+        ValidationReport report = blockchain.revalidate(walletManager, &revalidation);
+        lastRevalidation = report.toJSON();
+        revalidationRunning = false;
+        if (!report.valid)
+        {
+            LOG_ERROR("refusing to start on an invalid chain", {"block", report.failedBlock}, {"reason", report.reason});
+            Logger::flush();
+            return 1;
+        }
+    }
+
+    // block / mempool push to SSE subscribers (GET /events); declared first so it outlives
+    // everything that publishes through blockchain (admission workers, lanes)
+    EventHub events;
+    blockchain.setEventHub(&events);
+
+    // signed transaction admission: check -> verify -> commit stages (see AdmissionPipeline)
+    AdmissionPipeline admission(blockchain, walletManager);
+
+    // route classes with their own worker pools; must outlive the server
+    Lanes lanes;
+
     httplib::Server server;
+
+    // httplib's threads only own connections: they read a request, wait for its lane, write the
+    // response. By default there is one for every request the lanes can hold, one per event
+    // stream (held for the stream's lifetime) and a few for idle keep-alive connections;
+    // connections beyond that wait in httplib's queue, up to UMA_HTTP_MAX_QUEUED
+    const size_t maxSubscribers = (size_t)Config::getInt("UMA_SSE_MAX_SUBSCRIBERS", 64);
+    const size_t connectionThreads = (size_t)Config::getInt("UMA_HTTP_THREADS", lanes.capacity() + maxSubscribers + 8);
+    const size_t maxQueued = (size_t)Config::getInt("UMA_HTTP_MAX_QUEUED", 1024);
+    server.new_task_queue = [=]
+    { return new httplib::ThreadPool(connectionThreads, maxQueued); };
+
     std::string CLIENT_URL = std::getenv("CLIENT_URL") ? std::getenv("CLIENT_URL") : "*";
 
     // CORS helper: use CLIENT_URL for more restrictive policy in development
@@ -59,6 +131,18 @@ int main()
         res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
     };
 
+    // each route runs on its class's lane (own workers, bounded queue; see Lanes), where its
+    // JSON body also goes through Compression (size floor, per-endpoint level) before httplib
+    // writes it; streamed routes encode their own chunks and pass through untouched.
+    // Timing for /metrics covers the lane wait, handler and encoding.
+    auto route = [&lanes, &set_cors](Lanes::Lane lane, Compression::Profile profile, httplib::Server::Handler handler) -> httplib::Server::Handler
+    {
+        return RouteMetrics::timed(lanes.wrap(lane, [profile, handler = std::move(handler)](const httplib::Request &req, httplib::Response &res)
+                                              {
+            handler(req, res);
+            Compression::apply(req, res, profile); }, set_cors));
+    };
+
     // Preflight handler for any path
     server.Options(R"(/.*)", [&](const httplib::Request & /*req*/, httplib::Response &res)
                    {
@@ -67,18 +151,17 @@ int main()
         res.set_content("", "text/plain"); });
 
     // GET /chain -> returns full chain
-    server.Get("/chain", [&](const httplib::Request &, httplib::Response &res)
+    server.Get("/chain", route(Lanes::BULK, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
-        nlohmann::json jChain = nlohmann::json::array();
-
-        for (auto &block : blockchain.getChain())
-            jChain.push_back(block.toJSON());
+        ChainView chain = blockchain.snapshot();
 
         set_cors(res);
-        res.set_content(jChain.dump(4), "application/json"); });
+        if (ETag::notModified(req, res, ETag::make({chain->version})))
+            return;
+        JsonStream::blocks(req, res, chain, 0, chain->size()); }));
 
     // POST /add-transaction → add tx to mempool
-    server.Post("/add-transaction", [&](const httplib::Request &req, httplib::Response &res)
+    server.Post("/add-transaction", route(Lanes::INGRESS, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                 {
         std::string sender;
         std::string receiver;
@@ -87,6 +170,7 @@ int main()
         std::string sender_user_id;
         std::string signature; // base64
         std::string pubKeyPem; // optional
+        std::string feeStr;    // optional, paid to the miner
 
         // Support both application/x-www-form-urlencoded and multipart/form-data
         if (req.is_multipart_form_data()) {
@@ -97,6 +181,7 @@ int main()
             if (req.form.has_field("sender_user_id")) sender_user_id = req.form.get_field("sender_user_id");
             if (req.form.has_field("signature")) signature = req.form.get_field("signature");
             if (req.form.has_field("pubKeyPem")) pubKeyPem = req.form.get_field("pubKeyPem");
+            if (req.form.has_field("fee")) feeStr = req.form.get_field("fee");
         } else {
             sender = req.get_param_value("sender");
             receiver = req.get_param_value("receiver");
@@ -105,98 +190,122 @@ int main()
             sender_user_id = req.get_param_value("sender_user_id");
             signature = req.get_param_value("signature");
             pubKeyPem = req.get_param_value("pubKeyPem");
+            feeStr = req.get_param_value("fee");
         }
 
-        double amount = std::stod(amountStr);
+        AdmissionRequest request{sender, receiver, amountStr, feeStr, signature, pubKeyPem};
+        std::future<AdmissionResult> pending;
 
-       
-        // validate if sender and reciever wallet exists
-         if(!walletManager.walletExists(sender) || !walletManager.walletExists(receiver)){
-                   nlohmann::json response = {
-            {"success", false},
-            {"message", "Invalid Wallet Id"},
+        // checks, verification and insert happen in the admission pipeline; a full pipeline
+        // is answered right away instead of queueing without bound
+        if (!admission.submit(std::move(request), pending)) {
+            nlohmann::json response = {
+                {"success", false},
+                {"message", "Server busy, retry later"},
             };
 
             set_cors(res);
-            return res.set_content(response.dump(), "application/json"); 
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            return res.set_content(response.dump(), "application/json");
         }
 
-        // If pubKeyPem provided, ensure it matches stored pubkey for sender (if any), or bind it
-        std::string storedPub = walletManager.getPublicKey(sender);
-        
-        if (storedPub.empty() && !pubKeyPem.empty()) {
-            // bind provided pubkey to sender wallet
-            walletManager.bindPublicKeyToWallet(sender, pubKeyPem);
-            storedPub = pubKeyPem;
-        }
-
-        if (storedPub.empty()){
+        AdmissionResult result = pending.get();
+        if (!result.success) {
             nlohmann::json response = {
                 {"success", false},
-                {"message", "Public key not found for sender"}
+                {"message", result.message},
             };
 
-            
             set_cors(res);
-            return res.set_content(response.dump(), "application/json"); 
-        }
-
-        std::ostringstream oss;
-        {
-            // format amount in a temp stream so std::fixed doesn't affect later output
-            std::ostringstream amt_ss;
-            // amt_ss << std::fixed << std::setprecision(8) << amount;
-            oss << sender << "|" << receiver << "|" << amountStr;
+            return res.set_content(response.dump(), "application/json");
         }
 
-        std::string message = oss.str();
+        // return a simple JSON object confirming the operation
+        nlohmann::json response = {
+            {"success", true},
+            {"message", result.message},
+            {"new_balance", result.newBalance},
+        };
 
-        std::cout << "storedPub : " << storedPub << std::endl;
-        std::cout << "message : " << message << std::endl;
-        std::cout << "signature : " << signature << std::endl;
+        set_cors(res);
+        return res.set_content(response.dump(), "application/json"); }));
 
+    // POST /transactions/batch → JSON body, an array of signed transactions (or {"transactions": [...]}):
+    //   [{"sender", "receiver", "amount", "fee"?, "signature", "pubKeyPem"?}, ...]
+    // amount/fee should be strings exactly as signed. Signatures are verified in parallel and the
+    // batch is admitted in order under one lock; results[i] answers item i.
+    server.Post("/transactions/batch", route(Lanes::INGRESS, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
+                {
+        static const size_t maxItems = (size_t)Config::getInt("UMA_BATCH_MAX_TX", 1000);
+        set_cors(res);
 
-        bool ok = Crypto::verifySignaturePEM(storedPub, message, signature);
-        
-        if (!ok) {
+        auto fail = [&](int status, const std::string &message)
+        {
+            res.status = status;
             nlohmann::json response = {
                 {"success", false},
-                {"message", "Invalid Signature"}
+                {"message", message},
             };
+            res.set_content(response.dump(), "application/json");
+        };
 
-            
-            set_cors(res);
-            return res.set_content(response.dump(), "application/json"); 
-        }
-
-        Transaction tx(sender, receiver, amount);
+        nlohmann::json body = nlohmann::json::parse(req.body, nullptr, false);
+        if (body.is_object() && body.contains("transactions"))
+            body = body["transactions"];
+        if (!body.is_array())
+            return fail(400, "Expected a JSON array of transactions");
+        if (body.size() > maxItems)
+            return fail(413, "Batch too large, at most " + std::to_string(maxItems) + " transactions");
 
-        if(!blockchain.validateTransaction(tx)){
-                   nlohmann::json response = {
-            {"success", false},
-            {"message", "Insufficient funds"},
-            };
+        // a number is taken as its JSON text; clients should send the string they signed
+        auto field = [](const nlohmann::json &item, const char *name) -> std::string
+        {
+            auto it = item.find(name);
+            if (it == item.end() || it->is_null())
+                return "";
+            return it->is_string() ? it->get<std::string>() : it->dump();
+        };
 
-            set_cors(res);
-            return res.set_content(response.dump(), "application/json"); 
+        std::vector<AdmissionRequest> requests;
+        requests.reserve(body.size());
+        for (const auto &item : body)
+        {
+            if (!item.is_object())
+                return fail(400, "Every batch item must be an object");
+            requests.push_back({field(item, "sender"), field(item, "receiver"), field(item, "amount"),
+                                field(item, "fee"), field(item, "signature"), field(item, "pubKeyPem")});
         }
 
+        std::vector<AdmissionResult> results = admission.submitBatch(std::move(requests));
 
-        blockchain.addTransaction(tx);
-        double new_balance = blockchain.getEffectiveBalance(sender);
+        size_t accepted = 0;
+        nlohmann::json items = nlohmann::json::array();
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            nlohmann::json item = {
+                {"index", i},
+                {"success", results[i].success},
+                {"message", results[i].message},
+            };
+            if (results[i].success)
+            {
+                item["txid"] = results[i].txId;
+                accepted++;
+            }
+            items.push_back(std::move(item));
+        }
 
-        // return a simple JSON object confirming the operation
         nlohmann::json response = {
             {"success", true},
-            {"message", "Transaction added successfully"},
-            {"new_balance", new_balance},
+            {"accepted", accepted},
+            {"rejected", results.size() - accepted},
+            {"results", std::move(items)},
         };
-
-        set_cors(res);
-        return res.set_content(response.dump(), "application/json"); });
+        res.set_content(response.dump(), "application/json"); }));
 
     // GET /mine → mine new block
-    server.Get("/mine", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get("/mine", route(Lanes::ADMIN, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
                    auto miner_address = req.get_param_value("miner_address");
                    bool mined = blockchain.minePendingTransactions(miner_address, walletManager);
@@ -223,12 +332,89 @@ int main()
 
                               set_cors(res);
                               res.set_content(response.dump(), "application/json");
-                   } });
+                   } }));
+
+    // GET /mining/info -> current PoW target and retarget settings
+    server.Get("/mining/info", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &, httplib::Response &res)
+               {
+        nlohmann::json response = {
+            {"success", true},
+            {"target", blockchain.getTarget()},
+            {"difficulty", blockchain.getDifficulty()},
+            {"targetBlockMs", blockchain.getTargetBlockMs()},
+        };
+
+        set_cors(res);
+        res.set_content(response.dump(), "application/json"); }));
+
+    // GET /admission/stats -> admission pipeline counters and queue depths
+    server.Get("/admission/stats", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &, httplib::Response &res)
+               {
+        nlohmann::json response = admission.stats();
+        response["success"] = true;
+
+        set_cors(res);
+        res.set_content(response.dump(), "application/json"); }));
+
+    // POST /admin/revalidate -> start a full chain revalidation in the background
+    server.Post("/admin/revalidate", route(Lanes::ADMIN, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
+                {
+        set_cors(res);
+        if (!isAdminRequest(req)) {
+            res.status = 403;
+            nlohmann::json response = {{"success", false}, {"message", "Forbidden"}};
+            return res.set_content(response.dump(), "application/json");
+        }
+
+        bool expected = false;
+        if (!revalidationRunning.compare_exchange_strong(expected, true)) {
+            nlohmann::json response = {{"success", false}, {"message", "Revalidation already running"}, {"progress", revalidation.toJSON()}};
+            return res.set_content(response.dump(), "application/json");
+        }
+
+        std::thread([]() {
+            ValidationReport report = blockchain.revalidate(walletManager, &revalidation);
+            {
+                std::lock_guard<std::mutex> lock(revalidationMutex);
+                lastRevalidation = report.toJSON();
+            }
+            revalidationRunning = false;
+        }).detach();
+
+        nlohmann::json response = {{"success", true}, {"message", "Revalidation started"}};
+        res.set_content(response.dump(), "application/json"); }));
+
+    // GET /admin/revalidate -> progress of the current run and the last report
+    server.Get("/admin/revalidate", route(Lanes::ADMIN, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
+               {
+        set_cors(res);
+        if (!isAdminRequest(req)) {
+            res.status = 403;
+            nlohmann::json response = {{"success", false}, {"message", "Forbidden"}};
+            return res.set_content(response.dump(), "application/json");
+        }
+
+        nlohmann::json response = {
+            {"success", true},
+            {"running", revalidationRunning.load()},
+            {"progress", revalidation.toJSON()},
+        };
+        {
+            std::lock_guard<std::mutex> lock(revalidationMutex);
+            response["lastReport"] = lastRevalidation;
+        }
+        res.set_content(response.dump(), "application/json"); }));
 
     // GET /balance/:wallet
-    server.Get(R"(/balance/(.*))", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get(R"(/balance/(.*))", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &req, httplib::Response &res)
                {
         std::string wallet = req.matches[1];
+
+        // version first: it is bumped after the block is published, so it never runs ahead of the balance
+        set_cors(res);
+        if (ETag::notModified(req, res, ETag::make({blockchain.walletVersion(wallet)})))
+            return;
+
         double balance = blockchain.getBalance(wallet);
         
         nlohmann::json response = {
@@ -237,20 +423,43 @@ int main()
             {"balance", balance},
         };
 
-        set_cors(res);
-        res.set_content(response.dump(), "application/json"); });
+        res.set_content(response.dump(), "application/json"); }));
 
-    server.Get("/mempool", [&](auto &, auto &res)
+    server.Get("/mempool", route(Lanes::BULK, Compression::POLLED, [&](const httplib::Request &req, httplib::Response &res)
                {
+        set_cors(res);
+        if (ETag::notModified(req, res, ETag::make({blockchain.getMempool().version()})))
+            return;
+
         nlohmann::json jChain = nlohmann::json::array();
 
-        for (auto &tx : blockchain.getMempool())
-        jChain.push_back(tx.toJSON());
+        blockchain.getMempool().forEach([&](const Transaction &tx)
+                                        { jChain.push_back(tx.toJSON()); });
+
+        res.set_content(jChain.dump(4), "application/json"); }));
+
+    // GET /mempool/stats -> size and memory accounting of the pending pool
+    server.Get("/mempool/stats", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &, httplib::Response &res)
+               {
+        Mempool::Stats stats = blockchain.getMempool().stats();
+
+        nlohmann::json response = {
+            {"success", true},
+            {"count", stats.count},
+            {"bytes", stats.bytes},
+            {"maxBytes", stats.maxBytes},
+            {"admitted", stats.admitted},
+            {"evicted", stats.evicted},
+            {"expired", stats.expired},
+            {"rejectedFull", stats.rejectedFull},
+            {"duplicates", stats.duplicates},
+            {"ttlSlots", stats.ttlSlots},
+        };
 
         set_cors(res);
-        res.set_content(jChain.dump(4), "application/json"); });
+        res.set_content(response.dump(), "application/json"); }));
 
-    server.Post("/wallet/init", [&](const httplib::Request &req, httplib::Response &res)
+    server.Post("/wallet/init", route(Lanes::INGRESS, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                 {
         std::string userId;
         std::string pubKey;
@@ -271,19 +480,20 @@ int main()
         std::string wallet = walletManager.getOrCreateWallet(userId);
         double balance = walletManager.getBalance(wallet);
 
+        bool pubKeyBound = false;
          if (!pubKey.empty()) {
-        walletManager.bindPublicKeyToWallet(wallet, pubKey);
+        pubKeyBound = !walletManager.bindPublicKeyToWallet(wallet, pubKey).empty();
     }
         // std::string json = "{ \"wallet\": \"" + wallet +
         //                "\", \"balance\": " + std::to_string(balance) + " }";
        nlohmann::json response;
 
-     response = { {"success", true}, {"wallet", wallet}, {"balance", balance}, {"basePrice", UMA_PER_USD}, {"pubKeyBound", !pubKey.empty()} };
+     response = { {"success", true}, {"wallet", wallet}, {"balance", balance}, {"basePrice", UMA_PER_USD}, {"pubKeyBound", pubKeyBound} };
 
     set_cors(res);
-    res.set_content(response.dump(), "application/json"); });
+    res.set_content(response.dump(), "application/json"); }));
 
-    server.Get(R"(/wallet/balance/(.*))", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get(R"(/wallet/balance/(.*))", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &req, httplib::Response &res)
                {
         auto wallet = req.matches[1];
         double balance = walletManager.getBalance(wallet);
@@ -296,61 +506,80 @@ int main()
         };
 
         set_cors(res);
-        res.set_content(response.dump(), "application/json"); });
+        res.set_content(response.dump(), "application/json"); }));
 
-    server.Post("/transaction/send", [&](const httplib::Request &req, httplib::Response &res)
+    server.Post("/transaction/send", route(Lanes::INGRESS, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                 {
     std::string sender = req.get_param_value("sender");
     std::string receiver = req.get_param_value("receiver");
-    double amount = std::stod(req.get_param_value("amount"));
+    double amount = 0.0;
+    double fee = 0.0;
+    try
+    {
+        amount = std::stod(req.get_param_value("amount"));
+        if (req.has_param("fee")) fee = std::stod(req.get_param_value("fee"));
+    }
+    catch (...)
+    {
+        amount = 0.0;
+    }
+
+    // same rules as AdmissionPipeline::check
+    if (!std::isfinite(amount) || amount <= 0 || !std::isfinite(fee) || fee < 0) {
+        nlohmann::json response = { {"success", false}, {"message", !std::isfinite(amount) || amount <= 0 ? "Invalid amount" : "Invalid fee"} };
+        set_cors(res);
+        return res.set_content(response.dump(), "application/json");
+    }
 
     Transaction tx(sender, receiver, amount);
-    blockchain.addTransaction(tx);
+    tx.fee = fee;
+    Mempool::AddResult added = blockchain.addTransaction(tx);
 
     nlohmann::json response = {
-        {"success", true},
-        {"message", "Transaction added to pending"},
+        {"success", added == Mempool::ADDED},
+        {"message", added == Mempool::ADDED ? "Transaction added to pending" : added == Mempool::DUPLICATE ? "Duplicate transaction" : "Mempool full"},
         {"tx", {
             {"sender", sender},
             {"receiver", receiver},
             {"amount", amount},
+            {"fee", fee},
             {"status", "PENDING"}
         }}
     };
 
     set_cors(res);
-    res.set_content(response.dump(), "application/json"); });
+    res.set_content(response.dump(), "application/json"); }));
 
     // GET /blockchain/blocks?limit=50&offset=0
-    server.Get("/blockchain/blocks", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get("/blockchain/blocks", route(Lanes::BULK, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
     int limit = 50;
     int offset = 0;
     if (req.has_param("limit")) limit = std::stoi(req.get_param_value("limit"));
     if (req.has_param("offset")) offset = std::stoi(req.get_param_value("offset"));
 
-    auto blocks = blockchain.getBlocks(limit, offset);
-    nlohmann::json j = nlohmann::json::array();
-    for (auto &b : blocks) j.push_back(b.toJSON());
+    ChainView chain = blockchain.snapshot();
+    size_t begin = (size_t)std::max(offset, 0);
+    size_t end = begin + (size_t)std::max(limit, 0);
 
     set_cors(res);
-    res.set_content(j.dump(4), "application/json"); });
+    JsonStream::blocks(req, res, chain, begin, end); }));
 
     // GET /blockchain/block/:index
-    server.Get(R"(/blockchain/block/(\d+))", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get(R"(/blockchain/block/(\d+))", route(Lanes::POINT, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
     int idx = std::stoi(req.matches[1]);
-    if (idx < 0 || idx >= (int)blockchain.getChain().size()) {
+    ChainView chain = blockchain.snapshot(); // size check and lookup against the same version
+    if (idx < 0 || idx >= (int)chain->size()) {
         res.status = 404;
         res.set_content("{\"error\":\"block not found\"}", "application/json");
         return;
     }
-    Block b = blockchain.getBlockByIndex(idx);
     set_cors(res);
-    res.set_content(b.toJSON().dump(4), "application/json"); });
+    res.set_content(chain->json(idx), "application/json"); }));
 
     // GET /tx/:txid
-    server.Get(R"(/tx/(.*))", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get(R"(/tx/(.*))", route(Lanes::POINT, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
     std::string txid = req.matches[1];
     Transaction tx = blockchain.getTransactionById(txid);
@@ -360,37 +589,116 @@ int main()
         return;
     }
     set_cors(res);
-    res.set_content(tx.toJSON().dump(4), "application/json"); });
+    res.set_content(tx.toJSON().dump(4), "application/json"); }));
 
     // GET /wallet/:wallet/history
-    server.Get(R"(/wallet/(.*)/history)", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get(R"(/wallet/(.*)/history)", route(Lanes::BULK, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                {
     std::string wallet = req.matches[1];
-    std::cout << "wallet id : " << wallet << std::endl;
-    auto history = blockchain.getTransactionsForWallet(wallet);
-    nlohmann::json j = nlohmann::json::array();
-    for (auto &tx : history) j.push_back(tx.toJSON());
-    
-    nlohmann::json final_response = {
-        {"success" , true},
-        {"transactions" , j},
-    };
+    LOG_DEBUG("wallet history", {"wallet", wallet});
+    ChainView chain;
+    std::vector<Transaction> pending = blockchain.pendingForWallet(wallet, chain);
 
     set_cors(res);
-    res.set_content(final_response.dump(), "application/json"); });
+    JsonStream::walletHistory(req, res, wallet, std::move(pending), chain); }));
+
+    // GET /events?wallet=W -> text/event-stream of block-sealed, tx-admitted, tx-confirmed;
+    // with wallet, only tx events where W is sender or receiver (blocks always come through)
+    server.Get("/events", RouteMetrics::timed([&](const httplib::Request &req, httplib::Response &res)
+               {
+    set_cors(res);
+    if (events.subscriberCount() >= maxSubscribers)
+    {
+        res.status = 503;
+        res.set_header("Retry-After", "5");
+        res.set_content(nlohmann::json{{"success", false}, {"message", "too many event subscribers"}}.dump(), "application/json");
+        return;
+    }
+
+    std::string wallet = req.has_param("wallet") ? req.get_param_value("wallet") : "";
+    uint64_t lastId = 0;
+    std::string last = req.has_header("Last-Event-ID") ? req.get_header_value("Last-Event-ID") : req.get_param_value("lastEventId");
+    if (!last.empty())
+    {
+        try { lastId = std::stoull(last); } catch (...) { lastId = 0; }
+    }
+
+    auto sub = events.subscribe(wallet, lastId);
+    static const std::chrono::milliseconds heartbeat(Config::getInt("UMA_SSE_HEARTBEAT_MS", 15000));
+
+    res.set_header("Cache-Control", "no-cache");
+    res.set_header("X-Accel-Buffering", "no"); // no proxy buffering of the stream
+    auto started = std::make_shared<bool>(false);
+    res.set_chunked_content_provider(
+        "text/event-stream",
+        [sub, started](size_t, httplib::DataSink &sink)
+        {
+            std::string out;
+            if (!*started)
+            {
+                *started = true;
+                out = "retry: 3000\n\n"; // reconnect delay; Last-Event-ID picks up where this left off
+            }
+
+            switch (sub->next(out, heartbeat))
+            {
+            case EventHub::Subscriber::EVENTS:
+                break;
+            case EventHub::Subscriber::TIMEOUT:
+                out += ": keepalive\n\n"; // also how a vanished client gets noticed
+                break;
+            case EventHub::Subscriber::DROPPED:
+                out += "event: dropped\ndata: {\"reason\":\"slow consumer\"}\n\n";
+                sink.write(out.data(), out.size());
+                sink.done();
+                return true;
+            case EventHub::Subscriber::CLOSED:
+                sink.done();
+                return true;
+            }
+            return sink.write(out.data(), out.size());
+        },
+        [&events, sub](bool)
+        { events.unsubscribe(sub); }); }));
+
+    // GET /metrics -> Prometheus text format; sums per-thread shards without blocking request threads
+    server.Get("/metrics", [&](const httplib::Request &, httplib::Response &res)
+               {
+    res.set_content(Metrics::scrape(), "text/plain; version=0.0.4; charset=utf-8"); });
+
+    // GET /lanes/stats -> per-lane workers, queue and shed counts
+    server.Get("/lanes/stats", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &, httplib::Response &res)
+               {
+    nlohmann::json response = {{"success", true}, {"lanes", lanes.stats()}};
+    set_cors(res);
+    res.set_content(response.dump(), "application/json"); }));
+
+    // GET /events/stats
+    server.Get("/events/stats", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &, httplib::Response &res)
+               {
+    nlohmann::json response = events.stats();
+    response["success"] = true;
+    response["maxSubscribers"] = maxSubscribers;
+    set_cors(res);
+    res.set_content(response.dump(), "application/json"); }));
 
     // GET /transactions/latest?limit=20
-    server.Get("/transactions/latest", [&](const httplib::Request &req, httplib::Response &res)
+    server.Get("/transactions/latest", route(Lanes::POINT, Compression::POLLED, [&](const httplib::Request &req, httplib::Response &res)
                {
     int limit = 20;
     if (req.has_param("limit")) limit = std::stoi(req.get_param_value("limit"));
+
+    // both versions are read before the body, so the tag never claims more than it contains
+    set_cors(res);
+    if (ETag::notModified(req, res, ETag::make({blockchain.snapshot()->version, blockchain.getMempool().version()})))
+        return;
+
     auto latest = blockchain.getLatestTransactions(limit);
     nlohmann::json j = nlohmann::json::array();
     for (auto &tx : latest) j.push_back(tx.toJSON());
-    set_cors(res);
-    res.set_content(j.dump(4), "application/json"); });
+    res.set_content(j.dump(4), "application/json"); }));
 
-    server.Post("/buy", [&](const httplib::Request &req, httplib::Response &res)
+    server.Post("/buy", route(Lanes::CONFIRM, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                 {
 
     std::string wallet;
@@ -417,7 +725,7 @@ int main()
     double usd = 0.0;
     try { usd = std::stod(usdStr); } catch (...) { usd = 0.0; }
 
-    if (usd <= 0) {
+    if (!std::isfinite(usd) || usd <= 0) {
         nlohmann::json response = { {"success", false}, {"message", "Invalid USD amount"} };
         set_cors(res);
         return res.set_content(response.dump(), "application/json");
@@ -461,9 +769,9 @@ int main()
     };
 
     set_cors(res);
-    res.set_content(response.dump(), "application/json"); });
+    res.set_content(response.dump(), "application/json"); }));
 
-    server.Post("/sell", [&](const httplib::Request &req, httplib::Response &res)
+    server.Post("/sell", route(Lanes::CONFIRM, Compression::STANDARD, [&](const httplib::Request &req, httplib::Response &res)
                 {
     std::string wallet;
     std::string umaStr;
@@ -488,7 +796,7 @@ int main()
     double umaAmount = 0.0;
     try { umaAmount = std::stod(umaStr); } catch (...) { umaAmount = 0.0; }
 
-    if (umaAmount <= 0) {
+    if (!std::isfinite(umaAmount) || umaAmount <= 0) {
         nlohmann::json response = { {"success", false}, {"message", "Invalid UMA amount"} };
         set_cors(res);
         return res.set_content(response.dump(), "application/json");
@@ -500,9 +808,11 @@ int main()
         return res.set_content(response.dump(), "application/json");
     }
 
-    // Check balance (use walletManager)
-    double balance = blockchain.getEffectiveBalance(wallet);
-    if (balance < umaAmount) {
+    // check, debit and record a confirmed tx from wallet -> FIAT as one step, so two
+    // concurrent sells can't both spend the same balance
+    Transaction tx(wallet, "FIAT", umaAmount);
+    tx.status = TxStatus::CONFIRMED;
+    if (!blockchain.addConfirmedDebit(tx, walletManager)) {
         nlohmann::json response = { {"success", false}, {"message", "Insufficient UMA balance"} };
         set_cors(res);
         return res.set_content(response.dump(), "application/json");
@@ -511,21 +821,18 @@ int main()
     // convert UMA to USD (mock)
     double usdAmount = umaToUsd(umaAmount);
 
-    // Mock payout to bank
+    // Mock payout to bank; the debit is already recorded, so a failed payout is refunded
     if (!mockSendToBank(bankAccount, usdAmount)) {
+        walletManager.updateBalance(wallet, umaAmount);
+        Transaction refund("FIAT", wallet, umaAmount);
+        refund.status = TxStatus::CONFIRMED;
+        blockchain.addConfirmedTransaction(refund);
+
         nlohmann::json response = { {"success", false}, {"message", "Bank payout failed (mock)"} };
         set_cors(res);
         return res.set_content(response.dump(), "application/json");
     }
 
-    // debit user immediately
-    walletManager.updateBalance(wallet, -umaAmount);
-
-    // record a confirmed tx from wallet -> FIAT
-    Transaction tx(wallet, "FIAT", umaAmount);
-    tx.status = TxStatus::CONFIRMED;
-    blockchain.addConfirmedTransaction(tx);
-
     double newBalance = walletManager.getBalance(wallet);
 
     nlohmann::json response = {
@@ -538,11 +845,11 @@ int main()
     };
 
     set_cors(res);
-    res.set_content(response.dump(), "application/json"); });
-
-    std::cout << "Server running on http://localhost:8080\n";
+    res.set_content(response.dump(), "application/json"); }));
 
     int port = std::getenv("PORT") ? std::stoi(std::getenv("PORT")) : 8080;
+
+    LOG_INFO("server running", {"port", port});
     
     server.listen("0.0.0.0", port);
     
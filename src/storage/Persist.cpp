@@ -0,0 +1,82 @@
+#include "Persist.h"
+#include "../config/Config.h"
+#include "../log/Logger.h"
+#include "../metrics/Metrics.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unordered_map>
+#include <unistd.h>
+
+namespace
+{
+    struct FileMetrics
+    {
+        Metrics::Id bytes, writes, errors, writeTime, fsyncTime;
+
+        explicit FileMetrics(const std::string &what)
+        {
+            std::string l = "file=\"" + what + "\"";
+            bytes = Metrics::counter("uma_persist_bytes_total", "Bytes written to data files", l);
+            writes = Metrics::counter("uma_persist_writes_total", "Data file writes", l);
+            errors = Metrics::counter("uma_persist_errors_total", "Failed data file writes", l);
+            writeTime = Metrics::histogram("uma_persist_write_duration_seconds", "open + write + close of a data file", l);
+            fsyncTime = Metrics::histogram("uma_persist_fsync_duration_seconds", "fsync of a data file (UMA_PERSIST_FSYNC=1)", l);
+        }
+    };
+
+    const FileMetrics &metricsFor(const char *what)
+    {
+        // callers pass string literals; one entry per file, registered on first write
+        thread_local std::unordered_map<const char *, FileMetrics> local;
+        auto it = local.find(what);
+        if (it == local.end())
+            it = local.emplace(what, FileMetrics(what)).first;
+        return it->second;
+    }
+}
+
+bool Persist::writeFile(const std::string &path, const std::string &data, const char *what)
+{
+    static const bool doFsync = Config::getInt("UMA_PERSIST_FSYNC", 0) != 0;
+    const FileMetrics &m = metricsFor(what);
+    auto started = std::chrono::steady_clock::now();
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0;
+    size_t written = 0;
+    while (ok && written < data.size())
+    {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR)
+            continue;
+        ok = n > 0;
+        if (ok)
+            written += (size_t)n;
+    }
+
+    if (ok && doFsync)
+    {
+        auto syncStarted = std::chrono::steady_clock::now();
+        ok = ::fsync(fd) == 0;
+        Metrics::record(m.fsyncTime, std::chrono::steady_clock::now() - syncStarted);
+    }
+
+    int err = errno;
+    if (fd >= 0 && ::close(fd) != 0 && ok)
+    {
+        ok = false;
+        err = errno;
+    }
+
+    Metrics::record(m.writeTime, std::chrono::steady_clock::now() - started);
+    Metrics::add(m.writes);
+    Metrics::add(m.bytes, written);
+    if (!ok)
+    {
+        Metrics::add(m.errors);
+        LOG_ERROR("data file write failed", {"path", path}, {"error", std::strerror(err)});
+    }
+    return ok;
+}
@@ -0,0 +1,17 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <string>
+
+// Whole-file writes of the data/ snapshots (blockchain.json, wallets.json), timed and counted
+// under uma_persist_*{file="<what>"}. With UMA_PERSIST_FSYNC=1 each write is fsynced before
+// returning and the fsync is timed separately; the default (0) keeps the page-cache-only
+// behaviour, since wallet snapshots are written from inside the block commit.
+class Persist
+{
+public:
+    // replace path with data; false (and logged) on any I/O error
+    static bool writeFile(const std::string &path, const std::string &data, const char *what);
+};
+
+#endif
@@ -1,8 +1,11 @@
 #include "Transaction.h"
-#include <openssl/sha.h>
+#include "../codec/Codec.h"
+#include "../crypto/Sha256.h"
 #include <iomanip>
+#include <sstream>
+#include <vector>
 
-Transaction::Transaction() : sender(""), receiver(""), amount(0), status(PENDING), timestamp(0) {}
+Transaction::Transaction() : sender(""), receiver(""), amount(0), fee(0), status(PENDING), timestamp(0) {}
 
 
 Transaction::Transaction(const std::string &from, const std::string &to, double amt)
@@ -10,6 +13,7 @@ Transaction::Transaction(const std::string &from, const std::string &to, double
     sender = from;
     receiver = to;
     amount = amt;
+    fee = 0;
     status = PENDING;
     timestamp = (long long)(std::chrono::duration_cast<std::chrono::milliseconds>(
                                 std::chrono::system_clock::now().time_since_epoch())
@@ -52,15 +56,9 @@ Transaction::Transaction(const std::string &from, const std::string &to, double
  * @return A 64-character hexadecimal string representing the SHA256 hash of the transaction.
  *         Each of the 32 bytes in the SHA256 digest is converted to 2 hexadecimal characters.
  * 
- * @note The formatting stream manipulators work as follows:
- *       - std::hex: Sets the output base to hexadecimal (base 16)
- *       - std::setw(2): Sets the field width to 2 characters for the next value
- *       - std::setfill('0'): Pads the output with '0' characters to reach the field width
- *       - (int)hash[i]: Casts each unsigned char byte to int so it outputs as a number
- *                       instead of a character. Without this cast, the byte would be
- *                       interpreted as an ASCII character rather than a numeric value.
- *       
- *       Example: A byte value of 0x0A (decimal 10) outputs as "0a" instead of "\n"
+ * @note The digest is hex-encoded with Codec::hexEncode (lowercase, SIMD nibble lookup
+ *       where the CPU supports it). Same output as the old std::hex/setw(2)/setfill('0')
+ *       stream formatting, e.g. a byte 0x0A becomes "0a".
  */
 std::string Transaction::generateId(const std::string &sender, const std::string &receiver, double amount, long long timestamp)
 {
@@ -68,15 +66,10 @@ std::string Transaction::generateId(const std::string &sender, const std::string
     oss << sender << "|" << receiver << "|" << std::fixed << std::setprecision(8) << amount << "|" << timestamp;
     std::string s = oss.str();
 
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256((const unsigned char *)s.data(), s.size(), hash); // produces a 32-byte or 256 bit binary digest
+    unsigned char hash[Sha256::DIGEST_BYTES];
+    Sha256::digest(s.data(), s.size(), hash); // produces a 32-byte or 256 bit binary digest
 
-    std::ostringstream hex;
-    
-    for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i)
-        hex << std::hex << std::setw(2) << std::setfill('0') << (int)hash[i]; // each byte getting converted into 2 hexadecimal characters
-
-    return hex.str(); // for each byte 2 hexadecimal characters, that means for 32 byte -> 64 hexadecimal characters, the output string will be a string length of 64 characters
+    return Codec::hexEncode(hash, Sha256::DIGEST_BYTES); // for each byte 2 hexadecimal characters, that means for 32 byte -> 64 hexadecimal characters, the output string will be a string length of 64 characters
 }
 
 nlohmann::json Transaction::toJSON() const
@@ -86,12 +79,15 @@ nlohmann::json Transaction::toJSON() const
     j["sender"] = sender;
     j["receiver"] = receiver;
     j["amount"] = amount;
+    j["fee"] = fee;
     j["status"] = status;
     j["timestamp"] = timestamp;
     if (!signatureBase64.empty())
         j["signature"] = signatureBase64;
-    if (!pubKeyPem.empty())
-        j["pubKeyPem"] = pubKeyPem;
+    if (!signedMessage.empty())
+        j["signedMessage"] = signedMessage;
+    if (!signerKey.empty())
+        j["signerKey"] = signerKey;
     return j;
 }
 
@@ -102,9 +98,38 @@ Transaction Transaction::fromJSON(const nlohmann::json &j)
     tx.sender = j.value("sender", std::string());
     tx.receiver = j.value("receiver", std::string());
     tx.amount = j.value("amount", 0.0);
+    tx.fee = j.value("fee", 0.0);
     tx.status = j.value("status", PENDING);
     tx.timestamp = j.value("timestamp", 0LL);
     tx.signatureBase64 = j.value("signature", std::string());
-    tx.pubKeyPem = j.value("pubKeyPem", std::string());
+    tx.signedMessage = j.value("signedMessage", std::string());
+    tx.signerKey = j.value("signerKey", std::string());
     return tx;
-}
\ No newline at end of file
+}
+
+// the client signs amount/fee as typed ("1.5", "1.50"...), so compare numerically, not textually
+bool Transaction::matchesSignedMessage() const
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(signedMessage);
+    std::string part;
+    while (std::getline(ss, part, '|'))
+        parts.push_back(part);
+
+    if (parts.size() != 3 && parts.size() != 4)
+        return false;
+    if (parts[0] != sender || parts[1] != receiver)
+        return false;
+
+    try
+    {
+        if (std::stod(parts[2]) != amount)
+            return false;
+        double signedFee = parts.size() == 4 ? std::stod(parts[3]) : 0.0;
+        return signedFee == fee;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
@@ -17,11 +17,14 @@ public:
     std::string sender;
     std::string receiver;
     double amount;
+    double fee; // paid by sender to the miner, decides block inclusion priority
     TxStatus status;
     long long timestamp;
 
     std::string signatureBase64; // signature of canonical string
-    std::string pubKeyPem;       // sender's public key, PEM format
+    std::string signedMessage;   // exact string the client signed ("sender|receiver|amount[|fee]")
+    std::string signerKey;       // compact key ("p256:<base64>") the signature verified against at admission;
+                                 // empty on txs admitted before keys were recorded
 
     // constructors
     Transaction();
@@ -30,6 +33,8 @@ public:
     // helpers
     nlohmann::json toJSON() const;
     static Transaction fromJSON(const nlohmann::json &j);
+    bool isSigned() const { return !signatureBase64.empty(); }
+    bool matchesSignedMessage() const; // signedMessage really describes this sender/receiver/amount/fee
     static std::string generateId(const std::string &sender, const std::string &receiver, double amount, long long timestamp);
 };
 
@@ -1,5 +1,11 @@
 #include "WalletManager.h"
+#include "../crypto/Crypto.h"
+#include "../codec/Codec.h"
+#include "../log/Logger.h"
+#include "../storage/Persist.h"
 #include <fstream>
+#include <algorithm>
+#include <vector>
 #include <random>
 #include <iostream>
 
@@ -16,6 +22,22 @@ static std::string normalize_pem_crlf(const std::string &s) {
 
 using json = nlohmann::json;
 
+// persisted form of a compact key: "<type>:<base64 point>", e.g. "p256:A+O+QK9B..."
+static std::string compact_key_to_string(const CompactPublicKey &key)
+{
+    return Crypto::compactKeyToString(key);
+}
+
+// accepts the compact form, or a PEM from files written before keys were stored compact
+static bool compact_key_from_string(const std::string &s, CompactPublicKey &out)
+{
+    if (s.find(':') != std::string::npos && s.compare(0, 5, "-----") != 0)
+        return Crypto::compactKeyFromString(s, out);
+
+    std::shared_ptr<EVP_PKEY> key = Crypto::parsePublicKeyPEM(normalize_pem_crlf(s));
+    return key && Crypto::compactPublicKey(key.get(), out);
+}
+
 // constructor - to load wallet file
 WalletManager::WalletManager()
 {
@@ -34,16 +56,28 @@ std::string WalletManager::generateWalletId()
 // get existing or create new wallet
 std::string WalletManager::getOrCreateWallet(const std::string &userId)
 {
-    if (userToWallet.count(userId))
     {
-        return userToWallet[userId];
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = userToWallet.find(userId);
+        if (it != userToWallet.end())
+            return it->second;
     }
 
-    std::string newWallet = generateWalletId();
-    userToWallet[userId] = newWallet;
-    walletBalances[newWallet] = 0;
+    std::string newWallet, data;
+    uint64_t seq;
+    {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = userToWallet.find(userId);
+        if (it != userToWallet.end())
+            return it->second; // created by another request in between
+
+        newWallet = generateWalletId();
+        userToWallet[userId] = newWallet;
+        walletBalances[newWallet] = 0;
+        data = serialize(seq);
+    }
 
-    saveToFile();
+    writeFile(data, seq);
 
     return newWallet;
 }
@@ -51,9 +85,11 @@ std::string WalletManager::getOrCreateWallet(const std::string &userId)
 // get existing wallet
 std::string WalletManager::getWallet(const std::string &userId)
 {
-    if (userToWallet.count(userId))
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = userToWallet.find(userId);
+    if (it != userToWallet.end())
     {
-        return userToWallet[userId];
+        return it->second;
     }
 
     return "";
@@ -62,9 +98,11 @@ std::string WalletManager::getWallet(const std::string &userId)
 // get wallet balance
 double WalletManager::getBalance(const std::string &walletId)
 {
-    if (walletBalances.count(walletId))
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = walletBalances.find(walletId);
+    if (it != walletBalances.end())
     {
-        return walletBalances[walletId];
+        return it->second;
     }
 
     return 0;
@@ -73,8 +111,34 @@ double WalletManager::getBalance(const std::string &walletId)
 // update wallet balance
 void WalletManager::updateBalance(const std::string &walletId, double amount)
 {
+    save(adjustBalance(walletId, amount));
+}
+
+WalletManager::Snapshot WalletManager::adjustBalance(const std::string &walletId, double amount)
+{
+    Snapshot snapshot;
+    std::unique_lock<std::shared_mutex> lock(mtx);
     walletBalances[walletId] += amount;
-    saveToFile();
+    snapshot.data = serialize(snapshot.seq);
+    return snapshot;
+}
+
+WalletManager::Snapshot WalletManager::applyTransfers(const std::vector<Transaction> &txs)
+{
+    Snapshot snapshot;
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    for (const auto &tx : txs)
+    {
+        walletBalances[tx.sender] -= tx.amount + tx.fee;
+        walletBalances[tx.receiver] += tx.amount;
+    }
+    snapshot.data = serialize(snapshot.seq);
+    return snapshot;
+}
+
+void WalletManager::save(const Snapshot &snapshot)
+{
+    writeFile(snapshot.data, snapshot.seq);
 }
 
 // check if wallet exists or not
@@ -83,41 +147,128 @@ bool WalletManager::walletExists(const std::string &walletId)
     if (walletId.rfind("WALLET_", 0) != 0)
         return false;
 
+    std::shared_lock<std::shared_mutex> lock(mtx);
     return walletBalances.count(walletId) > 0;
 }
 
 std::string WalletManager::bindPublicKeyToWallet(const std::string &walletId, const std::string &pubKeyPem)
 {
-    if (!walletBalances.count(walletId))
+    // normalize CRLF to LF so keys pasted from any frontend parse the same (parsed outside the lock)
+    std::shared_ptr<EVP_PKEY> key = Crypto::parsePublicKeyPEM(normalize_pem_crlf(pubKeyPem));
+    CompactPublicKey compact;
+    if (!key || !Crypto::compactPublicKey(key.get(), compact))
     {
-        // maybe create it
-        walletBalances[walletId] = 0;
+        LOG_WARN("rejected public key", {"wallet", walletId});
+        return "";
+    }
+
+    std::string data;
+    uint64_t seq;
+    {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        if (!walletBalances.count(walletId))
+        {
+            // maybe create it
+            walletBalances[walletId] = 0;
+        }
+        // txs signed with the old key stay verifiable (see ChainValidator)
+        auto old = walletPublicKey.find(walletId);
+        if (old != walletPublicKey.end())
+        {
+            std::string previous = compact_key_to_string(old->second);
+            auto &retired = retiredKeys[walletId];
+            if (previous != compact_key_to_string(compact) && std::find(retired.begin(), retired.end(), previous) == retired.end())
+                retired.push_back(previous);
+        }
+        walletPublicKey[walletId] = compact;
+
+        // the parsed key goes straight into the cache; a rebind replaces whatever was there
+        verifyKeys.put(walletId, key);
+
+        data = serialize(seq);
     }
-    // normalize CRLF to LF so stored keys match what frontend signs/verifies
-    walletPublicKey[walletId] = normalize_pem_crlf(pubKeyPem);
-    saveToFile();
+
+    writeFile(data, seq);
     return walletId;
 }
 
+bool WalletManager::hasPublicKey(const std::string &walletId)
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return walletPublicKey.count(walletId) > 0;
+}
+
 std::string WalletManager::getPublicKey(const std::string &walletId)
 {
-    if (walletPublicKey.count(walletId))
-        return walletPublicKey[walletId];
-    return "";
+    std::shared_ptr<EVP_PKEY> key = getVerifyKey(walletId);
+    return key ? Crypto::publicKeyToPEM(key.get()) : "";
 }
 
-// save to wallets.json
-void WalletManager::saveToFile()
+std::shared_ptr<EVP_PKEY> WalletManager::getVerifyKey(const std::string &walletId, std::string *keyId)
+{
+    std::shared_ptr<EVP_PKEY> key = verifyKeys.get(walletId, keyId);
+    if (key)
+        return key;
+
+    // miss: never bound, or the cache entry was dropped; build the key outside the lock
+    CompactPublicKey compact;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = walletPublicKey.find(walletId);
+        if (it == walletPublicKey.end())
+            return nullptr;
+        compact = it->second;
+    }
+
+    key = Crypto::publicKeyFromCompact(compact);
+    if (!key)
+        return nullptr;
+
+    verifyKeys.put(walletId, key);
+    if (keyId)
+        *keyId = Crypto::publicKeyFingerprint(key.get());
+    return key;
+}
+
+bool WalletManager::wasKeyBound(const std::string &walletId, const std::string &compactKey)
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto current = walletPublicKey.find(walletId);
+    if (current != walletPublicKey.end() && compact_key_to_string(current->second) == compactKey)
+        return true;
+
+    auto retired = retiredKeys.find(walletId);
+    return retired != retiredKeys.end() &&
+           std::find(retired->second.begin(), retired->second.end(), compactKey) != retired->second.end();
+}
+
+// snapshot for wallets.json; numbered so an older snapshot never overwrites a newer one
+std::string WalletManager::serialize(uint64_t &seq)
 {
     json j;
 
     j["users"] = userToWallet;
     j["balances"] = walletBalances;
-    j["pubkeys"] = walletPublicKey;
+    json pubkeys = json::object();
+    for (const auto &kv : walletPublicKey)
+        pubkeys[kv.first] = compact_key_to_string(kv.second);
+    j["pubkeys"] = pubkeys;
+    if (!retiredKeys.empty())
+        j["retiredKeys"] = retiredKeys;
 
-    std::ofstream file(filename);
+    seq = ++saveSeq;
+    return j.dump(4);
+}
 
-    file << j.dump(4);
+// save to wallets.json
+void WalletManager::writeFile(const std::string &data, uint64_t seq)
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (seq < savedSeq)
+        return;
+    savedSeq = seq;
+
+    Persist::writeFile(filename, data, "wallets");
 }
 
 // load from wallets.json
@@ -144,10 +295,25 @@ void WalletManager::loadFromFile()
 
     if (j.contains("pubkeys"))
     {
-        walletPublicKey = j["pubkeys"].get<std::unordered_map<std::string, std::string>>();
-        // normalize any CRLF that might be present in stored pubkeys
-        for (auto &kv : walletPublicKey) {
-            kv.second = normalize_pem_crlf(kv.second);
+        for (auto &kv : j["pubkeys"].items())
+        {
+            CompactPublicKey compact;
+            if (!kv.value().is_string() || !compact_key_from_string(kv.value().get<std::string>(), compact))
+            {
+                LOG_WARN("skipping unreadable stored public key", {"wallet", kv.key()});
+                continue;
+            }
+            walletPublicKey[kv.key()] = compact;
+
+            // warm the verification key cache so the first /add-transaction doesn't build the key
+            std::shared_ptr<EVP_PKEY> key = Crypto::publicKeyFromCompact(compact);
+            if (key)
+                verifyKeys.put(kv.key(), key);
         }
     }
+
+    if (j.contains("retiredKeys"))
+    {
+        retiredKeys = j["retiredKeys"].get<std::unordered_map<std::string, std::vector<std::string>>>();
+    }
 }
\ No newline at end of file
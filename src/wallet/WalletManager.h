@@ -1,20 +1,45 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
 #include "../../include/json.hpp"
+#include "../crypto/KeyCache.h"
+#include "../crypto/Crypto.h"
+#include "../transaction/Transaction.h"
 
+// Thread safety: every public method takes mtx itself (shared for lookups, exclusive for
+// changes). Lock order is Blockchain::stateMutex -> mtx -> KeyCache; nothing here ever calls
+// back into the Blockchain. The file write happens after mtx is released.
 class WalletManager
 {
+public:
+    // wallets.json contents taken under mtx, written later by save()
+    struct Snapshot
+    {
+        std::string data;
+        uint64_t seq = 0;
+    };
+
 private:
     std::unordered_map<std::string, std::string> userToWallet;    // clerkId to walletId converter
     std::unordered_map<std::string, double> walletBalances;       // wallet id to balances
-    std::unordered_map<std::string, std::string> walletPublicKey; // walletId -> pubKeyPem
+    std::unordered_map<std::string, CompactPublicKey> walletPublicKey; // walletId -> curve tag + compressed point
+    std::unordered_map<std::string, std::vector<std::string>> retiredKeys; // walletId -> keys it was bound to before (compact strings)
+    KeyCache verifyKeys;                                          // walletId -> parsed key, filled at bind/load
 
     std::string filename = "../data/wallets.json";
 
+    mutable std::shared_mutex mtx; // guards the four maps above
+    std::mutex fileMutex;          // serializes writes of wallets.json
+    uint64_t saveSeq = 0;          // snapshot number, taken under mtx
+    uint64_t savedSeq = 0;         // newest snapshot on disk, under fileMutex
+
     std::string generateWalletId();
 
-    void saveToFile();
+    std::string serialize(uint64_t &seq); // mtx held
+    void writeFile(const std::string &data, uint64_t seq); // mtx not held; drops stale snapshots
     void loadFromFile();
 
 public:
@@ -24,7 +49,18 @@ public:
     std::string getWallet(const std::string &userId);
     double getBalance(const std::string &walletId);
     void updateBalance(const std::string &walletId, double amount);
+    Snapshot adjustBalance(const std::string &walletId, double amount); // updateBalance without the file write
+    // debit sender amount + fee and credit receiver for each tx under one lock; doesn't touch the
+    // file, so it can run inside the block commit: save() the result once the commit is done
+    Snapshot applyTransfers(const std::vector<Transaction> &txs);
+    void save(const Snapshot &snapshot); // drops it if a newer snapshot is already on disk
 
+    // parses the PEM once and keeps only the compact key; returns "" (nothing bound) if the key is unusable
     std::string bindPublicKeyToWallet(const std::string &walletId, const std::string &pubKeyPem);
-    std::string getPublicKey(const std::string &walletId);
+    bool hasPublicKey(const std::string &walletId);
+    std::string getPublicKey(const std::string &walletId); // PEM, built on demand for API responses
+    // parsed key for Crypto::verifySignature, nullptr if none/invalid; keyId gets its fingerprint
+    std::shared_ptr<EVP_PKEY> getVerifyKey(const std::string &walletId, std::string *keyId = nullptr);
+    // compactKey (Crypto::compactKeyToString form) is, or once was, bound to walletId
+    bool wasKeyBound(const std::string &walletId, const std::string &compactKey);
 };
\ No newline at end of file
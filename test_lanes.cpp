@@ -0,0 +1,151 @@
+// Lane isolation check against a running server: keeps the CONFIRM lane busy with concurrent
+// /buy calls (each seals its own block) and measures /balance (POINT) and /wallet/init (INGRESS)
+// latency before and during the load. Fails if either p99 degrades past the threshold, or a
+// single request waits as long as a block takes to seal (it queued behind the buys).
+//
+//   make test_lanes && ./server &  ./test_lanes [--host H] [--port P] [--buyers N] [--seconds S]
+//
+// Prints one JSON object per line, like the benchmarks; exit status 0 = pass.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "include/httplib.h"
+#include "include/json.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::string host = "localhost";
+    int port = 8080;
+    int buyers = 24; // more than the ingress lane has threads, so sharing a lane would show
+    double seconds = 5.0;
+    double maxP99Ms = 250; // absolute ceiling under load...
+    double maxSlowdown = 5; // ...unless the baseline p99 is already within this factor of it
+    double maxStallMs = 500; // no single request under load may take this long
+};
+
+static void emit(const nlohmann::json &j)
+{
+    std::cout << j.dump() << std::endl;
+}
+
+static double p99(std::vector<double> ms)
+{
+    if (ms.empty())
+        return 0;
+    std::sort(ms.begin(), ms.end());
+    return ms[std::min(ms.size() - 1, (size_t)(ms.size() * 0.99))];
+}
+
+// time one request per iteration until stop is set (or n requests when n > 0)
+static std::vector<double> sample(const Options &o, const std::function<bool(httplib::Client &)> &request,
+                                  const std::atomic<bool> *stop, int n)
+{
+    httplib::Client client(o.host, o.port);
+    std::vector<double> ms;
+    for (int i = 0; (stop && !stop->load()) || (!stop && i < n); i++)
+    {
+        auto started = Clock::now();
+        if (!request(client))
+            continue;
+        ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return ms;
+}
+
+int main(int argc, char **argv)
+{
+    Options o;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!std::strcmp(argv[i], "--host"))
+            o.host = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--port"))
+            o.port = std::stoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--buyers"))
+            o.buyers = std::stoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--seconds"))
+            o.seconds = std::stod(argv[i + 1]);
+    }
+
+    httplib::Client setup(o.host, o.port);
+    auto init = setup.Post("/wallet/init", "user_id=lane-check", "application/x-www-form-urlencoded");
+    if (!init || init->status != 200)
+    {
+        std::cerr << "no server at " << o.host << ":" << o.port << std::endl;
+        return 2;
+    }
+    std::string wallet = nlohmann::json::parse(init->body).value("wallet", std::string());
+
+    auto balance = [&](httplib::Client &c)
+    {
+        auto r = c.Get("/balance/" + wallet);
+        return r && r->status == 200;
+    };
+    auto walletInit = [&](httplib::Client &c)
+    {
+        auto r = c.Post("/wallet/init", "user_id=lane-check", "application/x-www-form-urlencoded");
+        return r && r->status == 200;
+    };
+
+    double baseBalance = p99(sample(o, balance, nullptr, 200));
+    double baseInit = p99(sample(o, walletInit, nullptr, 200));
+
+    // load: every buyer keeps one /buy in flight
+    std::atomic<bool> stop{false};
+    std::atomic<int> bought{0}, shed{0};
+    std::vector<std::thread> buyers;
+    for (int b = 0; b < o.buyers; b++)
+        buyers.emplace_back([&]()
+                            {
+            httplib::Client c(o.host, o.port);
+            c.set_read_timeout(120);
+            while (!stop.load())
+            {
+                auto r = c.Post("/buy", "wallet=" + wallet + "&usd=1&cardNumber=1", "application/x-www-form-urlencoded");
+                if (r && r->status == 200)
+                    bought++;
+                else if (r && r->status == 503)
+                {
+                    shed++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+            } });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // let the buys occupy their lane
+    std::vector<double> loadBalance, loadInit;
+    std::thread b1([&]()
+                   { loadBalance = sample(o, balance, &stop, 0); });
+    std::thread b2([&]()
+                   { loadInit = sample(o, walletInit, &stop, 0); });
+    std::this_thread::sleep_for(std::chrono::duration<double>(o.seconds));
+    stop = true;
+    b1.join();
+    b2.join();
+    for (auto &t : buyers)
+        t.join();
+
+    int failures = 0;
+    auto report = [&](const char *route, double base, const std::vector<double> &load)
+    {
+        double loaded = p99(load);
+        double worst = load.empty() ? 0 : *std::max_element(load.begin(), load.end());
+        bool ok = !load.empty() && (loaded <= o.maxP99Ms || loaded <= base * o.maxSlowdown) && worst < o.maxStallMs;
+        failures += ok ? 0 : 1;
+        emit({{"route", route}, {"baselineP99Ms", base}, {"loadedP99Ms", loaded}, {"loadedMaxMs", worst}, {"samples", load.size()}, {"pass", ok}});
+    };
+    report("/balance", baseBalance, loadBalance);
+    report("/wallet/init", baseInit, loadInit);
+    emit({{"buyers", o.buyers}, {"buysCompleted", bought.load()}, {"buysShed", shed.load()}});
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Mempool bookkeeping checks: admit and mine transactions in rounds and make sure the TTL queue
+// never grows with the total number of transactions seen.
+//
+//   make test_mempool && ./test_mempool      (exit status 0 = pass)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "mempool/Mempool.h"
+
+static int failures = 0;
+
+static void check(bool ok, const std::string &what)
+{
+    std::cout << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    if (!ok)
+        failures++;
+}
+
+// admits rounds * perRound txs, mining (removing) each round right after admitting it;
+// returns the largest TTL queue seen after an expire() pass
+static size_t admitAndMine(Mempool &pool, int rounds, int perRound)
+{
+    size_t maxSlots = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        std::vector<Transaction> round;
+        for (int i = 0; i < perRound; i++)
+        {
+            Transaction tx("S" + std::to_string(i), "R", 1.0 + r * perRound + i);
+            tx.id = "tx-" + std::to_string(r) + "-" + std::to_string(i);
+            pool.add(tx);
+            round.push_back(tx);
+        }
+        pool.remove(round);
+        pool.expire();
+        maxSlots = std::max(maxSlots, pool.stats().ttlSlots);
+    }
+    return maxSlots;
+}
+
+int main()
+{
+    const int rounds = 200, perRound = 100;
+
+    {
+        Mempool pool(0, 0); // no TTL
+        size_t maxSlots = admitAndMine(pool, rounds, perRound);
+        check(pool.stats().admitted == (unsigned long long)rounds * perRound, "ttl=0: every tx admitted");
+        check(pool.size() == 0, "ttl=0: every tx mined");
+        check(maxSlots == 0, "ttl=0: TTL queue stays empty (max " + std::to_string(maxSlots) + ")");
+    }
+
+    {
+        Mempool pool(0, 3600 * 1000); // nothing expires during the run, so only compaction bounds it
+        size_t maxSlots = admitAndMine(pool, rounds, perRound);
+        check(pool.size() == 0, "ttl=1h: every tx mined");
+        check(maxSlots <= 1024 + perRound, "ttl=1h: stale TTL slots are compacted (max " + std::to_string(maxSlots) + ")");
+    }
+
+    return failures == 0 ? 0 : 1;
+}